@@ -0,0 +1,300 @@
+// End-to-end benchmark of the detector: per-stage latency percentiles, throughput
+// and peak memory for a model over a directory of images or a video.
+//
+//   ./cv_app_bench [--cfg ../models/yolov7-tiny.cfg] [--weights ../models/yolov7-tiny.weights]
+//                  [--input ../samples/videoplayback.mp4 | <image dir>] [--warmup 10] [--iters 100]
+//                  [--conf 0.25] [--nms 0.4] [--letterbox 0|1] [--backend opencv] [--target cpu]
+//                  [--threads 0] [--json <path>|-]
+//                  [--producers 0] [--contexts 2] [--async_batch 4]
+
+#include "async_detector.h"
+#include "inference.h"
+#include "json.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Frames from an image directory or a video, looping so any iteration count works
+class FrameSource {
+public:
+    bool open(const std::string& input) {
+        if (cap.open(input) && cap.isOpened()) {
+            return true;
+        }
+        std::vector<std::string> files;
+        cv::glob(input, files, false);
+        for (const std::string& file : files) {
+            std::string lower = file;
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+            if (lower.size() > 4 &&
+                (lower.compare(lower.size() - 4, 4, ".jpg") == 0 ||
+                 lower.compare(lower.size() - 4, 4, ".png") == 0 ||
+                 lower.compare(lower.size() - 4, 4, ".bmp") == 0 ||
+                 lower.compare(lower.size() - 5, 5, ".jpeg") == 0)) {
+                images.push_back(file);
+            }
+        }
+        return !images.empty();
+    }
+
+    bool read(cv::Mat& frame) {
+        if (!images.empty()) {
+            frame = cv::imread(images[next_image++ % images.size()]);
+            return !frame.empty();
+        }
+        if (cap.read(frame)) {
+            return true;
+        }
+        // Rewind at the end of the video
+        cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+        return cap.read(frame);
+    }
+
+private:
+    cv::VideoCapture cap;
+    std::vector<std::string> images;
+    size_t next_image = 0;
+};
+
+struct StageSamples {
+    const char* name;
+    std::vector<double> ms;
+};
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+// Peak resident set size of the process in MiB
+double peakRssMb() {
+#ifdef __linux__
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss / 1024.0; // kilobytes on Linux
+    }
+#endif
+    return 0.0;
+}
+
+double ticksToMs(int64_t ticks) {
+    return ticks * 1000.0 / cv::getTickFrequency();
+}
+
+struct AsyncResult {
+    double throughput_fps;
+    std::vector<double> latency_ms;  // submit to result, per request
+    BatchDispatcherStats dispatcher;
+};
+
+// Many producer threads calling detectAsync() on a shared AsyncDetector, each
+// waiting for its own result before submitting the next frame
+AsyncResult runAsync(const YOLODetector& prototype, const AsyncConfig& async_cfg,
+                     const std::vector<cv::Mat>& frames, int producers, int warmup, int iters) {
+    AsyncDetector async_detector(prototype, async_cfg);
+    // Full batches allocate their own buffers on first use; pay for that untimed
+    std::vector<std::future<std::vector<Detection>>> warmup_results;
+    for (int i = 0; i < warmup; ++i) {
+        warmup_results.push_back(async_detector.detectAsync(frames[i % frames.size()]));
+    }
+    for (std::future<std::vector<Detection>>& result : warmup_results) {
+        result.get();
+    }
+    const BatchDispatcherStats warm = async_detector.getStats();
+    std::vector<std::vector<double>> latencies(producers);
+    std::vector<std::thread> threads;
+    int64_t start = cv::getTickCount();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = p; i < iters; i += producers) {
+                int64_t submitted = cv::getTickCount();
+                async_detector.detectAsync(frames[i % frames.size()]).get();
+                latencies[p].push_back(ticksToMs(cv::getTickCount() - submitted));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double elapsed_sec = ticksToMs(cv::getTickCount() - start) / 1000.0;
+
+    AsyncResult result;
+    result.throughput_fps = elapsed_sec > 0 ? iters / elapsed_sec : 0.0;
+    for (const std::vector<double>& samples : latencies) {
+        result.latency_ms.insert(result.latency_ms.end(), samples.begin(), samples.end());
+    }
+    result.dispatcher = async_detector.getStats();
+    result.dispatcher.frames_processed -= warm.frames_processed;
+    result.dispatcher.batches -= warm.batches;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::unordered_map<std::string, std::string> args;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        args[argv[i]] = argv[i + 1];
+    }
+    std::string cfg = args.count("--cfg") ? args["--cfg"] : "../models/yolov7-tiny.cfg";
+    std::string weights = args.count("--weights") ? args["--weights"] : "../models/yolov7-tiny.weights";
+    std::string input = args.count("--input") ? args["--input"] : "../samples/videoplayback.mp4";
+    std::string names = args.count("--names") ? args["--names"] : "../coco.names";
+    int warmup = args.count("--warmup") ? std::max(0, std::stoi(args["--warmup"])) : 10;
+    int iters = args.count("--iters") ? std::max(1, std::stoi(args["--iters"])) : 100;
+
+    YOLOConfig config(weights, cfg);
+    config.class_names = YOLOUtils::loadClassNames(names);
+    config.confidence_threshold = args.count("--conf") ? std::stof(args["--conf"]) : 0.25f;
+    config.nms_threshold = args.count("--nms") ? std::stof(args["--nms"]) : 0.4f;
+    config.letterbox = args.count("--letterbox") && (args["--letterbox"] == "true" || args["--letterbox"] == "1");
+    if (args.count("--backend")) config.backend = YOLOUtils::parseBackend(args["--backend"]);
+    if (args.count("--target")) config.target = YOLOUtils::parseTarget(args["--target"]);
+    if (args.count("--threads")) config.num_threads = std::stoi(args["--threads"]);
+
+    FrameSource source;
+    if (!source.open(input)) {
+        std::cerr << "Could not open input (video or image directory): " << input << std::endl;
+        return 1;
+    }
+
+    int64_t load_start = cv::getTickCount();
+    YOLODetector detector(config);
+    double load_ms = ticksToMs(cv::getTickCount() - load_start);
+
+    std::vector<StageSamples> stages = {
+        {"decode", {}}, {"preprocess", {}}, {"forward", {}}, {"parse", {}},
+        {"nms", {}}, {"draw", {}}, {"total", {}}
+    };
+    for (StageSamples& stage : stages) {
+        stage.ms.reserve(iters);
+    }
+
+    std::cerr << "Benchmarking " << cfg << " on " << input << ": "
+              << warmup << " warmup + " << iters << " timed iterations" << std::endl;
+
+    cv::Mat frame;
+    size_t total_detections = 0;
+    int64_t timed_start = 0;
+    for (int it = 0; it < warmup + iters; ++it) {
+        if (it == warmup) {
+            timed_start = cv::getTickCount();
+        }
+        int64_t start = cv::getTickCount();
+        if (!source.read(frame)) {
+            std::cerr << "Could not read a frame from " << input << std::endl;
+            return 1;
+        }
+        int64_t decoded = cv::getTickCount();
+        std::vector<Detection> detections = detector.detect(frame);
+        int64_t detected = cv::getTickCount();
+        YOLOUtils::drawDetections(frame, detections);
+        int64_t drawn = cv::getTickCount();
+
+        if (it < warmup) continue;
+        const StageTimings& timings = detector.getLastTimings();
+        stages[0].ms.push_back(ticksToMs(decoded - start));
+        stages[1].ms.push_back(timings.preprocess_ms);
+        stages[2].ms.push_back(timings.forward_ms);
+        stages[3].ms.push_back(timings.parse_ms);
+        stages[4].ms.push_back(timings.nms_ms);
+        stages[5].ms.push_back(ticksToMs(drawn - detected));
+        stages[6].ms.push_back(ticksToMs(drawn - start));
+        total_detections += detections.size();
+    }
+    double elapsed_sec = ticksToMs(cv::getTickCount() - timed_start) / 1000.0;
+
+    nlohmann::json report;
+    report["model"] = {{"cfg", cfg}, {"weights", weights},
+                       {"input_width", config.input_size.width},
+                       {"input_height", config.input_size.height}};
+    report["backend"] = YOLOUtils::backendName(detector.getConfig().backend);
+    report["target"] = YOLOUtils::targetName(detector.getConfig().target);
+    report["input"] = input;
+    report["warmup"] = warmup;
+    report["iterations"] = iters;
+    report["load_ms"] = load_ms;
+    const StartupTimings& startup = detector.getStartupTimings();
+    report["startup"] = {{"map_ms", startup.map_ms}, {"parse_ms", startup.parse_ms},
+                         {"warmup_ms", startup.warmup_ms}};
+    report["throughput_fps"] = elapsed_sec > 0 ? iters / elapsed_sec : 0.0;
+    report["peak_rss_mb"] = peakRssMb();
+    report["detections_per_frame"] = static_cast<double>(total_detections) / iters;
+
+    // Keep stdout clean for the JSON report when it goes there
+    const bool json_to_stdout = args.count("--json") && args["--json"] == "-";
+    FILE* table = json_to_stdout ? stderr : stdout;
+    std::fprintf(table, "stage          p50 ms    p90 ms    p99 ms   mean ms\n");
+    for (const StageSamples& stage : stages) {
+        double mean = std::accumulate(stage.ms.begin(), stage.ms.end(), 0.0) / stage.ms.size();
+        double p50 = percentile(stage.ms, 0.50);
+        double p90 = percentile(stage.ms, 0.90);
+        double p99 = percentile(stage.ms, 0.99);
+        report["stages"][stage.name] = {{"p50_ms", p50}, {"p90_ms", p90}, {"p99_ms", p99}, {"mean_ms", mean}};
+        std::fprintf(table, "%-12s %9.3f %9.3f %9.3f %9.3f\n", stage.name, p50, p90, p99, mean);
+    }
+    std::fprintf(table, "throughput: %.2f FPS, peak RSS: %.1f MiB, model load: %.1f ms\n",
+                report["throughput_fps"].get<double>(), report["peak_rss_mb"].get<double>(), load_ms);
+
+    int producers = args.count("--producers") ? std::max(0, std::stoi(args["--producers"])) : 0;
+    if (producers > 0) {
+        AsyncConfig async_cfg;
+        if (args.count("--contexts")) async_cfg.num_contexts = std::max(1, std::stoi(args["--contexts"]));
+        if (args.count("--async_batch")) async_cfg.max_batch = std::max(1, std::stoi(args["--async_batch"]));
+
+        // Decoding stays out of the measurement: producers cycle through preloaded frames
+        std::vector<cv::Mat> frames;
+        for (int i = 0; i < std::min(iters, 16); ++i) {
+            if (!source.read(frame)) break;
+            frames.push_back(frame.clone());
+        }
+        if (frames.empty()) {
+            std::cerr << "Could not read a frame from " << input << std::endl;
+            return 1;
+        }
+        AsyncResult async_result = runAsync(detector, async_cfg, frames, producers, warmup, iters);
+
+        const BatchDispatcherStats& batches = async_result.dispatcher;
+        double mean_batch = batches.batches > 0 ? static_cast<double>(batches.frames_processed) / batches.batches : 0.0;
+        double p50 = percentile(async_result.latency_ms, 0.50);
+        double p90 = percentile(async_result.latency_ms, 0.90);
+        double p99 = percentile(async_result.latency_ms, 0.99);
+        report["async"] = {{"producers", producers}, {"contexts", async_cfg.num_contexts},
+                           {"max_batch", async_cfg.max_batch},
+                           {"throughput_fps", async_result.throughput_fps},
+                           {"mean_batch", mean_batch},
+                           {"latency", {{"p50_ms", p50}, {"p90_ms", p90}, {"p99_ms", p99}}}};
+        std::fprintf(table, "async: %d producers, %d contexts: %.2f FPS, mean batch %.2f, "
+                     "latency p50 %.3f / p90 %.3f / p99 %.3f ms\n",
+                     producers, async_cfg.num_contexts, async_result.throughput_fps, mean_batch, p50, p90, p99);
+    }
+
+    if (args.count("--json")) {
+        const std::string& path = args["--json"];
+        if (json_to_stdout) {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream out(path);
+            if (!out) {
+                std::cerr << "Could not write report: " << path << std::endl;
+                return 1;
+            }
+            out << report.dump(2) << std::endl;
+        }
+    }
+    return 0;
+}
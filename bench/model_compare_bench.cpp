@@ -0,0 +1,341 @@
+// Accuracy vs speed comparison of model variants (e.g. Darknet FP32, ONNX FP16 and
+// int8 QDQ) and DNN targets over a labeled image set. Reports mAP@0.5, mAP@0.5:0.95,
+// the mAP delta against the first variant and the detection latency.
+//
+//   ./model_compare_bench --models ../models/yolov7-tiny.weights,../models/yolov7-tiny-int8.onnx
+//                         --images ../val/images [--labels ../val/labels] [--names ../coco.names]
+//                         [--targets cpu,cpu_fp16] [--cfg <darknet cfg>] [--conf 0.001] [--nms 0.6]
+//                         [--letterbox 0|1] [--backend opencv] [--threads 0] [--warmup 5]
+//                         [--limit 0] [--json <path>|-]
+//
+// Labels are YOLO text files named like the images: one "class cx cy w h" line per
+// object, normalized to the image size. A .weights model without --cfg uses the .cfg
+// next to it.
+
+#include "inference.h"
+#include "json.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+struct GroundTruth {
+    int class_id;
+    cv::Rect2f box;
+};
+
+struct LabeledImage {
+    std::string path;
+    cv::Mat image;
+    std::vector<GroundTruth> truth;
+};
+
+// One detection of the whole run, kept for the AP computation
+struct ScoredBox {
+    float score;
+    int image;
+    int class_id;
+    cv::Rect2f box;
+};
+
+struct Variant {
+    std::string label;
+    std::string model;
+    std::string cfg;
+    int target;
+};
+
+struct VariantResult {
+    double map50;
+    double map50_95;
+    double p50_ms;
+    double p90_ms;
+    double mean_ms;
+    double forward_p50_ms;
+    std::string target;  // after the detector's availability fallback
+};
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string stripExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    return (dot == std::string::npos || (slash != std::string::npos && dot < slash)) ? path : path.substr(0, dot);
+}
+
+bool isImageFile(const std::string& path) {
+    std::string lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    for (const char* ext : {".jpg", ".jpeg", ".png", ".bmp"}) {
+        size_t n = std::string(ext).size();
+        if (lower.size() > n && lower.compare(lower.size() - n, n, ext) == 0) return true;
+    }
+    return false;
+}
+
+std::vector<GroundTruth> readLabels(const std::string& path, const cv::Size& image_size) {
+    std::vector<GroundTruth> truth;
+    std::ifstream file(path);
+    GroundTruth object;
+    float cx, cy, w, h;
+    while (file >> object.class_id >> cx >> cy >> w >> h) {
+        object.box = cv::Rect2f((cx - 0.5f * w) * image_size.width, (cy - 0.5f * h) * image_size.height,
+                                w * image_size.width, h * image_size.height);
+        truth.push_back(object);
+    }
+    return truth;
+}
+
+float boxIoU(const cv::Rect2f& a, const cv::Rect2f& b) {
+    float inter = (a & b).area();
+    float uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0.f;
+}
+
+// COCO-style AP: precision envelope sampled at 101 recall points
+double averagePrecision(const std::vector<double>& recall, const std::vector<double>& precision) {
+    std::vector<double> envelope(precision);
+    for (int i = static_cast<int>(envelope.size()) - 2; i >= 0; --i) {
+        envelope[i] = std::max(envelope[i], envelope[i + 1]);
+    }
+    double sum = 0;
+    size_t k = 0;
+    for (int r = 0; r <= 100; ++r) {
+        double level = r / 100.0;
+        while (k < recall.size() && recall[k] < level) ++k;
+        sum += k < recall.size() ? envelope[k] : 0.0;
+    }
+    return sum / 101.0;
+}
+
+// mAP over the classes present in the labels at IoU 0.5 and averaged over 0.5:0.05:0.95
+void meanAveragePrecision(const std::vector<LabeledImage>& images, std::vector<ScoredBox> detections,
+                          double& map50, double& map50_95) {
+    std::sort(detections.begin(), detections.end(),
+              [](const ScoredBox& a, const ScoredBox& b) { return a.score > b.score; });
+    std::map<int, int> truth_per_class;
+    for (const LabeledImage& image : images) {
+        for (const GroundTruth& object : image.truth) ++truth_per_class[object.class_id];
+    }
+    map50 = 0;
+    map50_95 = 0;
+    if (truth_per_class.empty()) return;
+
+    for (const auto& entry : truth_per_class) {
+        const int class_id = entry.first;
+        double ap50 = 0, ap_sum = 0;
+        for (int t = 0; t < 10; ++t) {
+            const float iou_threshold = 0.5f + 0.05f * t;
+            std::vector<std::vector<char>> matched(images.size());
+            for (size_t i = 0; i < images.size(); ++i) matched[i].assign(images[i].truth.size(), 0);
+            std::vector<double> recall, precision;
+            int tp = 0, fp = 0;
+            for (const ScoredBox& detection : detections) {
+                if (detection.class_id != class_id) continue;
+                const std::vector<GroundTruth>& truth = images[detection.image].truth;
+                int best = -1;
+                float best_iou = iou_threshold;
+                for (size_t g = 0; g < truth.size(); ++g) {
+                    if (truth[g].class_id != class_id || matched[detection.image][g]) continue;
+                    float iou = boxIoU(detection.box, truth[g].box);
+                    if (iou >= best_iou) {
+                        best_iou = iou;
+                        best = static_cast<int>(g);
+                    }
+                }
+                if (best >= 0) {
+                    matched[detection.image][best] = 1;
+                    ++tp;
+                } else {
+                    ++fp;
+                }
+                recall.push_back(static_cast<double>(tp) / entry.second);
+                precision.push_back(static_cast<double>(tp) / (tp + fp));
+            }
+            double ap = averagePrecision(recall, precision);
+            if (t == 0) ap50 = ap;
+            ap_sum += ap;
+        }
+        map50 += ap50;
+        map50_95 += ap_sum / 10.0;
+    }
+    map50 /= truth_per_class.size();
+    map50_95 /= truth_per_class.size();
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+double ticksToMs(int64_t ticks) {
+    return ticks * 1000.0 / cv::getTickFrequency();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::unordered_map<std::string, std::string> args;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        args[argv[i]] = argv[i + 1];
+    }
+    if (!args.count("--models") || !args.count("--images")) {
+        std::cerr << "Usage: " << argv[0] << " --models <model>[,<model>...] --images <image dir>"
+                  << " [--labels <label dir>] [--targets cpu[,cpu_fp16...]] [--names coco.names]"
+                  << " [--cfg <darknet cfg>] [--conf 0.001] [--nms 0.6] [--letterbox 0|1]"
+                  << " [--backend opencv] [--threads 0] [--warmup 5] [--limit 0] [--json <path>|-]" << std::endl;
+        return 1;
+    }
+    const std::string image_dir = args["--images"];
+    const std::string label_dir = args.count("--labels") ? args["--labels"] : image_dir;
+    const std::string names = args.count("--names") ? args["--names"] : "../coco.names";
+    const int warmup = args.count("--warmup") ? std::max(0, std::stoi(args["--warmup"])) : 5;
+    const int limit = args.count("--limit") ? std::max(0, std::stoi(args["--limit"])) : 0;
+
+    // Images are decoded once up front so every variant sees identical input and
+    // the latency covers detection only
+    std::vector<std::string> files;
+    cv::glob(image_dir, files, false);
+    std::vector<LabeledImage> images;
+    size_t labeled_objects = 0;
+    for (const std::string& file : files) {
+        if (!isImageFile(file)) continue;
+        if (limit > 0 && static_cast<int>(images.size()) >= limit) break;
+        LabeledImage labeled;
+        labeled.path = file;
+        labeled.image = cv::imread(file);
+        if (labeled.image.empty()) {
+            std::cerr << "Could not read image: " << file << std::endl;
+            continue;
+        }
+        labeled.truth = readLabels(label_dir + "/" + stripExtension(baseName(file)) + ".txt",
+                                   labeled.image.size());
+        labeled_objects += labeled.truth.size();
+        images.push_back(std::move(labeled));
+    }
+    if (images.empty()) {
+        std::cerr << "No images found in " << image_dir << std::endl;
+        return 1;
+    }
+    if (labeled_objects == 0) {
+        std::cerr << "No labels found in " << label_dir << ", mAP will be 0" << std::endl;
+    }
+
+    std::vector<Variant> variants;
+    std::vector<std::string> targets = splitList(args.count("--targets") ? args["--targets"] : "cpu");
+    for (const std::string& model : splitList(args["--models"])) {
+        for (const std::string& target : targets) {
+            Variant variant;
+            variant.model = model;
+            variant.cfg = YOLOUtils::isOnnxModel(model) ? ""
+                        : args.count("--cfg") ? args["--cfg"] : stripExtension(model) + ".cfg";
+            variant.target = YOLOUtils::parseTarget(target);
+            variant.label = baseName(model);
+            variants.push_back(variant);
+        }
+    }
+
+    std::cerr << "Comparing " << variants.size() << " variants on " << images.size() << " images ("
+              << labeled_objects << " labeled objects)" << std::endl;
+
+    std::vector<VariantResult> results;
+    for (const Variant& variant : variants) {
+        YOLOConfig config(variant.model, variant.cfg);
+        config.class_names = YOLOUtils::loadClassNames(names);
+        // mAP needs the low-score tail of the precision/recall curve
+        config.confidence_threshold = args.count("--conf") ? std::stof(args["--conf"]) : 0.001f;
+        config.nms_threshold = args.count("--nms") ? std::stof(args["--nms"]) : 0.6f;
+        config.letterbox = args.count("--letterbox") && (args["--letterbox"] == "true" || args["--letterbox"] == "1");
+        if (args.count("--backend")) config.backend = YOLOUtils::parseBackend(args["--backend"]);
+        if (args.count("--threads")) config.num_threads = std::stoi(args["--threads"]);
+        config.target = variant.target;
+        YOLODetector detector(config);
+
+        for (int i = 0; i < warmup; ++i) {
+            detector.detect(images[i % images.size()].image);
+        }
+        std::vector<double> total_ms, forward_ms;
+        std::vector<ScoredBox> detections;
+        for (size_t i = 0; i < images.size(); ++i) {
+            int64_t start = cv::getTickCount();
+            std::vector<Detection> found = detector.detect(images[i].image);
+            total_ms.push_back(ticksToMs(cv::getTickCount() - start));
+            forward_ms.push_back(detector.getLastTimings().forward_ms);
+            for (const Detection& detection : found) {
+                detections.push_back(ScoredBox{detection.confidence, static_cast<int>(i), detection.class_id,
+                                               cv::Rect2f(detection.bbox)});
+            }
+        }
+
+        VariantResult result;
+        meanAveragePrecision(images, detections, result.map50, result.map50_95);
+        result.p50_ms = percentile(total_ms, 0.50);
+        result.p90_ms = percentile(total_ms, 0.90);
+        result.mean_ms = std::accumulate(total_ms.begin(), total_ms.end(), 0.0) / total_ms.size();
+        result.forward_p50_ms = percentile(forward_ms, 0.50);
+        result.target = YOLOUtils::targetName(detector.getConfig().target);
+        results.push_back(result);
+        std::cerr << variant.label << " / " << result.target << ": mAP50 " << result.map50
+                  << ", p50 " << result.p50_ms << " ms" << std::endl;
+    }
+
+    // The first variant is the baseline for the deltas and the speedup
+    const bool json_to_stdout = args.count("--json") && args["--json"] == "-";
+    FILE* table = json_to_stdout ? stderr : stdout;
+    nlohmann::json report;
+    report["images"] = images.size();
+    report["labeled_objects"] = labeled_objects;
+    std::fprintf(table, "%-28s %-9s %7s %9s %8s %8s %8s %8s %8s\n", "model", "target", "mAP50",
+                 "mAP50-95", "dmAP50", "p50 ms", "p90 ms", "fwd ms", "speedup");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const VariantResult& r = results[i];
+        double delta = r.map50 - results[0].map50;
+        double speedup = r.p50_ms > 0 ? results[0].p50_ms / r.p50_ms : 0.0;
+        std::fprintf(table, "%-28s %-9s %7.4f %9.4f %+8.4f %8.2f %8.2f %8.2f %7.2fx\n",
+                     variants[i].label.c_str(), r.target.c_str(), r.map50, r.map50_95, delta,
+                     r.p50_ms, r.p90_ms, r.forward_p50_ms, speedup);
+        report["variants"].push_back({{"model", variants[i].model}, {"target", r.target},
+                                      {"map50", r.map50}, {"map50_95", r.map50_95},
+                                      {"map50_delta", delta}, {"map50_95_delta", r.map50_95 - results[0].map50_95},
+                                      {"p50_ms", r.p50_ms}, {"p90_ms", r.p90_ms}, {"mean_ms", r.mean_ms},
+                                      {"forward_p50_ms", r.forward_p50_ms}, {"speedup", speedup}});
+    }
+
+    if (args.count("--json")) {
+        const std::string& path = args["--json"];
+        if (json_to_stdout) {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream out(path);
+            if (!out) {
+                std::cerr << "Could not write report: " << path << std::endl;
+                return 1;
+            }
+            out << report.dump(2) << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Micro-benchmark for YOLO output decoding: scalar reference vs SIMD path.
+//
+// Record real output tensors once:
+//   ./parse_outputs_bench --record <cfg> <weights> <image> <tensors.yml.gz>
+// Then benchmark on them (synthetic yolov7-tiny 640x640 tensors when omitted):
+//   ./parse_outputs_bench [--tensors tensors.yml.gz] [--iters 200] [--conf 0.25]
+
+#include "yolo_decode.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+struct RecordedOutputs {
+    std::vector<cv::Mat> outputs;
+    cv::Size image_size;
+};
+
+bool recordOutputs(const std::string& cfg, const std::string& weights,
+                   const std::string& image_path, const std::string& out_path) {
+    cv::Mat image = cv::imread(image_path);
+    if (image.empty()) {
+        std::cerr << "Could not read image: " << image_path << std::endl;
+        return false;
+    }
+    cv::dnn::Net net = cv::dnn::readNetFromDarknet(cfg, weights);
+    cv::Mat blob;
+    cv::dnn::blobFromImage(image, blob, 1.0 / 255.0, cv::Size(640, 640), cv::Scalar(), true, false);
+    net.setInput(blob);
+    std::vector<cv::Mat> outputs;
+    net.forward(outputs, net.getUnconnectedOutLayersNames());
+
+    cv::FileStorage fs(out_path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        std::cerr << "Could not write tensors: " << out_path << std::endl;
+        return false;
+    }
+    fs << "image_width" << image.cols;
+    fs << "image_height" << image.rows;
+    fs << "num_outputs" << static_cast<int>(outputs.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        fs << ("output_" + std::to_string(i)) << outputs[i];
+    }
+    std::cout << "Recorded " << outputs.size() << " output tensors to " << out_path << std::endl;
+    return true;
+}
+
+bool loadOutputs(const std::string& path, RecordedOutputs& recorded) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        std::cerr << "Could not read tensors: " << path << std::endl;
+        return false;
+    }
+    int width = 0, height = 0, count = 0;
+    fs["image_width"] >> width;
+    fs["image_height"] >> height;
+    fs["num_outputs"] >> count;
+    recorded.image_size = cv::Size(width, height);
+    for (int i = 0; i < count; ++i) {
+        cv::Mat output;
+        fs["output_" + std::to_string(i)] >> output;
+        recorded.outputs.push_back(output);
+    }
+    return !recorded.outputs.empty();
+}
+
+// yolov7-tiny at 640x640: three heads (80x80, 40x40, 20x20) x 3 anchors x 85 values,
+// with roughly 0.5% of rows carrying a confident object
+RecordedOutputs syntheticOutputs() {
+    RecordedOutputs recorded;
+    recorded.image_size = cv::Size(1920, 1080);
+    cv::RNG rng(12345);
+    const int grids[] = {80, 40, 20};
+    for (int grid : grids) {
+        cv::Mat output(grid * grid * 3, 85, CV_32F);
+        for (int r = 0; r < output.rows; ++r) {
+            float* row = output.ptr<float>(r);
+            row[0] = rng.uniform(0.f, 1.f);
+            row[1] = rng.uniform(0.f, 1.f);
+            row[2] = rng.uniform(0.01f, 0.3f);
+            row[3] = rng.uniform(0.01f, 0.3f);
+            row[4] = rng.uniform(0.f, 1.f) < 0.005f ? rng.uniform(0.5f, 1.f) : rng.uniform(0.f, 0.05f);
+            for (int c = 5; c < 85; ++c) {
+                row[c] = rng.uniform(0.f, 0.1f);
+            }
+            if (row[4] > 0.5f) {
+                row[5 + rng.uniform(0, 80)] = rng.uniform(0.5f, 1.f);
+            }
+        }
+        recorded.outputs.push_back(output);
+    }
+    return recorded;
+}
+
+typedef void (*DecodeFn)(const float*, int, int, float, const LetterboxTransform&, std::vector<cv::Rect>&,
+                         std::vector<float>&, std::vector<int>&);
+
+// Median per-frame decode time in microseconds; `kept` receives the candidate count
+double timeDecode(DecodeFn decode, const RecordedOutputs& recorded, float conf,
+                  int iters, size_t& kept) {
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confidences;
+    std::vector<int> class_ids;
+    boxes.reserve(1024);
+    confidences.reserve(1024);
+    class_ids.reserve(1024);
+    const LetterboxTransform transform(recorded.image_size, cv::Size(640, 640), false);
+    std::vector<double> samples;
+    samples.reserve(iters);
+    for (int it = 0; it < iters; ++it) {
+        boxes.clear();
+        confidences.clear();
+        class_ids.clear();
+        int64_t start = cv::getTickCount();
+        for (const cv::Mat& output : recorded.outputs) {
+            int rows = output.dims == 3 ? output.size[1] : output.rows;
+            int cols = output.dims == 3 ? output.size[2] : output.cols;
+            decode(output.ptr<float>(), rows, cols, conf, transform,
+                   boxes, confidences, class_ids);
+        }
+        samples.push_back((cv::getTickCount() - start) * 1e6 / cv::getTickFrequency());
+    }
+    kept = boxes.size();
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 6 && std::string(argv[1]) == "--record") {
+        return recordOutputs(argv[2], argv[3], argv[4], argv[5]) ? 0 : 1;
+    }
+
+    std::unordered_map<std::string, std::string> args;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        args[argv[i]] = argv[i + 1];
+    }
+    int iters = args.count("--iters") ? std::stoi(args["--iters"]) : 200;
+    float conf = args.count("--conf") ? std::stof(args["--conf"]) : 0.25f;
+
+    RecordedOutputs recorded;
+    if (args.count("--tensors")) {
+        if (!loadOutputs(args["--tensors"], recorded)) return 1;
+    } else {
+        recorded = syntheticOutputs();
+    }
+
+    size_t total_rows = 0;
+    for (const cv::Mat& output : recorded.outputs) {
+        total_rows += output.dims == 3 ? output.size[1] : output.rows;
+    }
+    std::cout << "Decoding " << total_rows << " rows, conf " << conf
+              << ", " << iters << " iterations" << std::endl;
+
+    size_t kept_scalar = 0, kept_simd = 0;
+    double scalar_us = timeDecode(decodeYoloRowsScalar, recorded, conf, iters, kept_scalar);
+    double simd_us = timeDecode(decodeYoloRows, recorded, conf, iters, kept_simd);
+
+    std::cout << "scalar: " << scalar_us << " us/frame (" << kept_scalar << " candidates)\n"
+              << "simd:   " << simd_us << " us/frame (" << kept_simd << " candidates)\n"
+              << "speedup: " << (simd_us > 0 ? scalar_us / simd_us : 0.0) << "x" << std::endl;
+    if (kept_scalar != kept_simd) {
+        std::cerr << "Mismatch between scalar and SIMD candidate counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
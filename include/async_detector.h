@@ -0,0 +1,56 @@
+#ifndef ASYNC_DETECTOR_H
+#define ASYNC_DETECTOR_H
+
+#include "inference.h"
+#include "batch_dispatcher.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Settings of an AsyncDetector
+struct AsyncConfig {
+    int num_contexts;    // detector clones, each with its own scratch buffers and thread
+    int max_batch;       // concurrent requests merged into one forward pass
+    int max_wait_ms;     // how long a partial batch waits for more requests
+    size_t max_pending;  // detectAsync() blocks while this many requests wait (0 = no limit)
+
+    AsyncConfig();
+};
+
+// Thread-safe front end to YOLODetector for many producer threads. Requests go
+// into one queue and are merged into batched forward passes on a pool of detector
+// clones (a YOLODetector itself is not thread-safe: it reuses its blob and
+// candidate buffers on every call). Clones share the mapped model, so a context
+// costs a cv::dnn::Net and its buffers, not another copy of the weights.
+//
+// The image is shared, not copied: do not write into it until its result is ready.
+class AsyncDetector {
+public:
+    typedef BatchDispatcher::ResultCallback ResultCallback;
+    typedef BatchDispatcher::ErrorCallback ErrorCallback;
+
+    // Clones its contexts from prototype, which stays usable by the caller
+    explicit AsyncDetector(const YOLODetector& prototype, const AsyncConfig& cfg = AsyncConfig());
+    // Finishes every accepted request, then joins the workers
+    ~AsyncDetector();
+    AsyncDetector(const AsyncDetector&) = delete;
+    AsyncDetector& operator=(const AsyncDetector&) = delete;
+
+    // The future holds the detections, or the exception inference threw. After
+    // shutdown() it holds a std::runtime_error.
+    std::future<std::vector<Detection>> detectAsync(const cv::Mat& image);
+    // Callback variant: on_done, or on_error if inference throws, runs on an inference
+    // thread. Without on_error a failed request gets an empty result. Returns false,
+    // without calling either, after shutdown().
+    bool detectAsync(const cv::Mat& image, ResultCallback on_done, ErrorCallback on_error = ErrorCallback());
+
+    void shutdown();
+    BatchDispatcherStats getStats() const;
+
+private:
+    std::vector<std::unique_ptr<YOLODetector>> contexts;
+    std::unique_ptr<BatchDispatcher> dispatcher;
+};
+
+#endif // ASYNC_DETECTOR_H
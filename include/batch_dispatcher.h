@@ -0,0 +1,91 @@
+#ifndef BATCH_DISPATCHER_H
+#define BATCH_DISPATCHER_H
+
+#include "inference.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Batching policy for BatchDispatcher
+struct BatchConfig {
+    int max_batch;               // frames per forward pass
+    int max_wait_ms;             // how long a partial batch may wait for more frames
+    size_t per_source_capacity;  // pending frames kept per source, oldest dropped first (0 = no limit)
+    size_t max_pending;          // submit() blocks while this many frames wait (0 = never blocks)
+
+    BatchConfig();
+};
+
+struct BatchDispatcherStats {
+    uint64_t frames_submitted;
+    uint64_t frames_dropped;
+    uint64_t frames_processed;
+    uint64_t batches;
+    size_t pending;
+};
+
+// Collects frames from several sources and runs them through
+// YOLODetector::detectBatch. Batches are filled round-robin across sources so
+// a busy source cannot starve the others; a batch only holds frames of one
+// input size. One worker thread per detector.
+class BatchDispatcher {
+public:
+    // Called on a worker thread once the frame's detections are ready
+    typedef std::function<void(std::vector<Detection>&&)> ResultCallback;
+    // Called instead of the result callback when the batch's inference throws
+    typedef std::function<void(std::exception_ptr)> ErrorCallback;
+
+    BatchDispatcher(const std::vector<YOLODetector*>& detectors, const BatchConfig& cfg);
+    ~BatchDispatcher();
+
+    // Queues a frame; returns false after stop(). If the source already has
+    // per_source_capacity frames pending, its oldest frame is dropped and its
+    // callback is never invoked. input_size is the network input size for this
+    // frame (empty = the detector's configured size). Without on_error a failed
+    // batch is logged and its frames get empty results.
+    bool submit(int source_id, const cv::Mat& frame, ResultCallback on_done,
+                const cv::Size& input_size = cv::Size(), ErrorCallback on_error = ErrorCallback());
+
+    // Processes what is still pending, then joins the workers
+    void stop();
+    BatchDispatcherStats getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Request {
+        cv::Mat frame;
+        cv::Size input_size;
+        ResultCallback on_done;
+        ErrorCallback on_error;
+        Clock::time_point arrival;
+    };
+
+    BatchConfig config;
+    std::map<int, std::deque<Request>> pending;
+    int last_source;
+    size_t pending_count;
+    bool stopping;
+
+    uint64_t frames_submitted;
+    uint64_t frames_dropped;
+    uint64_t frames_processed;
+    uint64_t batches;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable space_ready;  // max_pending back-pressure
+    std::vector<std::thread> workers;
+
+    void workerLoop(YOLODetector* detector);
+    Clock::time_point oldestArrival() const;
+    void takeBatch(std::vector<Request>& batch);
+};
+
+#endif // BATCH_DISPATCHER_H
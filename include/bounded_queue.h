@@ -0,0 +1,103 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// What push() does when the queue is full
+enum class QueuePolicy {
+    Block,      // wait until a consumer makes room
+    DropOldest  // discard the oldest queued item
+};
+
+// Thread-safe FIFO with a fixed capacity, used to join pipeline stages
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    size_t max_items;
+    QueuePolicy policy;
+    size_t num_dropped;
+    bool closed;
+
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+public:
+    BoundedQueue(size_t capacity, QueuePolicy queue_policy)
+        : max_items(capacity > 0 ? capacity : 1), policy(queue_policy),
+          num_dropped(0), closed(false) {}
+
+    // Returns false if the queue was closed before the item could be queued
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (policy == QueuePolicy::Block) {
+            not_full.wait(lock, [this] { return closed || items.size() < max_items; });
+        }
+        if (closed) {
+            return false;
+        }
+        if (items.size() >= max_items) {
+            items.pop_front();
+            ++num_dropped;
+        }
+        items.push_back(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Blocks until an item is available; returns false once closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Non-blocking variant of pop()
+    bool tryPop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Wakes every waiter; queued items can still be drained with pop()
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+    size_t dropped() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return num_dropped;
+    }
+
+    size_t capacity() const { return max_items; }
+};
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,88 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Video decoding backend behind a VideoSource
+enum class CaptureBackend {
+    Auto,       // whatever OpenCV picks for the source
+    FFmpeg,     // threaded software decoding, VA-API when available
+    GStreamer   // decodebin pipeline that can scale in the decoder
+};
+
+// Settings of the capture stage
+struct CaptureConfig {
+    CaptureBackend backend;
+    bool hw_decode;         // use VA-API when a render node is present, otherwise skipped
+    int decode_threads;     // FFmpeg decoder threads (0 = decoder default)
+    cv::Size scale_to;      // decoder-side scaling, GStreamer only (empty = native size)
+    size_t ring_size;       // frame buffers recycled between capture and inference
+    int open_timeout_ms;    // network sources: give up opening after this long (0 = backend default)
+    int read_timeout_ms;    // network sources: a read blocking this long fails (0 = backend default)
+
+    CaptureConfig();
+};
+
+CaptureBackend parseCaptureBackend(const std::string& name);
+// True when a DRM render node exists, i.e. VA-API decoding may work
+bool vaapiAvailable();
+bool isNetworkUrl(const std::string& url);
+bool isCameraIndex(const std::string& url);
+
+// Preallocated frames handed out round-robin. A buffer is reused once every Mat
+// that shared it downstream has been released, so decoding writes into memory
+// that is already mapped instead of allocating a new frame each time. When all
+// buffers are still in use a fresh one is allocated and the ring moves on.
+class FrameRing {
+private:
+    std::vector<cv::Mat> buffers;
+    size_t next;
+    std::atomic<uint64_t> allocations;  // read by the stats reporter
+
+public:
+    explicit FrameRing(size_t size);
+
+    // A buffer nobody else references; its old contents are to be overwritten
+    cv::Mat& acquire();
+    // Frames that could not reuse a buffer of the right size
+    uint64_t allocated() const { return allocations; }
+};
+
+// cv::VideoCapture behind the backend choice of CaptureConfig. Sources are a
+// camera index, a file, a network URL or, for GStreamer, a complete pipeline
+// ending in appsink. Decoded frames land in the buffers of a FrameRing.
+class VideoSource {
+private:
+    CaptureConfig config;
+    cv::VideoCapture cap;
+    FrameRing ring;
+    std::string backend_name;
+    bool hw_active;
+
+    bool openGStreamer(const std::string& source, bool hw);
+    bool openFFmpeg(const std::string& source, bool hw);
+
+public:
+    explicit VideoSource(const CaptureConfig& cfg = CaptureConfig());
+
+    bool open(const std::string& source);
+    bool isOpened() const { return cap.isOpened(); }
+    void release() { cap.release(); }
+
+    // The returned frame shares a ring buffer; drop it when done to recycle it
+    bool read(cv::Mat& frame);
+    bool grab() { return cap.grab(); }
+    bool retrieve(cv::Mat& frame);
+    double get(int property) const { return cap.get(property); }
+
+    const std::string& backendName() const { return backend_name; }
+    bool hwAccelerated() const { return hw_active; }
+    uint64_t frameAllocations() const { return ring.allocated(); }
+};
+
+#endif // CAPTURE_H
@@ -5,6 +5,13 @@
 #include <opencv2/dnn.hpp>
 #include <vector>
 #include <string>
+#include <map>
+#include <memory>
+#include "bounded_queue.h"
+#include "preprocess.h"
+#include "nms.h"
+#include "motion_gate.h"
+#include "stream_ingestor.h"
 
 // Detection result structure
 struct Detection {
@@ -12,46 +19,171 @@ struct Detection {
     float confidence;
     cv::Rect bbox;
     std::string class_name;
+    int track_id;  // persistent id assigned by the tracker (-1 = untracked)
     
     Detection(int id, float conf, cv::Rect box, const std::string& name = "");
 };
 
 // YOLO model configuration
 struct YOLOConfig {
-    std::string model_path;
-    std::string config_path;
+    std::string model_path;  // Darknet .weights, or an .onnx model (FP32, FP16 or int8 QDQ)
+    std::string config_path; // Darknet .cfg, unused for ONNX
     std::vector<std::string> class_names;
     float confidence_threshold;
     float nms_threshold;
+    NmsMethod nms_method;    // hard, soft (Gaussian) or diou
+    bool nms_per_class;      // false = suppress across classes
+    int nms_top_k;           // best candidates kept before suppression (0 = all)
+    float soft_nms_sigma;    // Gaussian decay of Soft-NMS
     cv::Size input_size;
     cv::Scalar mean;
     double scale_factor;
     bool swap_rb;
+    bool letterbox;          // keep aspect ratio and pad instead of stretching
+    float letterbox_pad;     // pixel value of the padding bars
+    int backend;             // cv::dnn::Backend, falls back to OpenCV if unavailable
+    int target;              // cv::dnn::Target or YOLOUtils::AUTO_TARGET, falls back to CPU if unavailable
+    int num_threads;         // cv::setNumThreads for the process (0 = OpenCV default)
+    std::vector<int> cpu_affinity; // CPUs to pin inference threads to (empty = no pinning)
+    bool warmup;             // one forward pass on a blank input at construction, so the
+                             // first frame does not pay for layer fusion and allocation
     
     YOLOConfig(const std::string& model, const std::string& config = "");
 };
 
+// Sliced inference for frames much larger than the network input; see tiling.h
+struct TilingConfig {
+    bool enabled;
+    bool zones_only;            // tile only the intrusion zones instead of the whole frame
+    std::vector<cv::Rect> regions; // frame areas to tile (empty = whole frame)
+    cv::Size tile_size;         // in frame pixels (0 x 0 = network input size, i.e. native resolution)
+    float overlap;              // fraction of a tile shared with its neighbour
+    int max_batch;              // tiles per forward pass
+    int workers;                // detectors running tile batches in parallel
+    bool full_frame;            // also run the downscaled full frame for large objects
+    float merge_iou;            // IoU of the cross-tile NMS
+
+    TilingConfig();
+};
+
+// Network input resolution chosen per stream; see input_size.h
+struct InputSizeConfig {
+    bool auto_select;           // switch between small_size and large_size at runtime
+    cv::Size small_size;
+    cv::Size large_size;
+    int min_object_px;          // objects smaller than this at small_size ask for large_size
+    int hold_frames;            // detector runs without small objects before going back down
+    int probe_interval;         // runs at small_size between probes at large_size (0 = never)
+    double latency_budget_ms;   // large_size only while its forward pass fits (0 = no budget)
+
+    InputSizeConfig();
+};
+
+// Threading configuration for the capture / inference / render pipeline
+struct PipelineConfig {
+    int num_workers;            // inference threads, each with its own detector
+    CaptureConfig capture;      // decoding backend and frame buffers of the capture thread
+    size_t queue_capacity;      // bound of the capture and result queues
+    QueuePolicy queue_policy;
+    MotionGateConfig motion;    // run the detector only on changed or stale frames
+    IngestConfig ingest;        // reconnect backoff and newest-frame buffering of the source
+    bool tracking;              // track ids, and predicted boxes on frames without inference
+    TilingConfig tiling;
+    InputSizeConfig input_size;
+    double stats_interval_sec;  // period of the queue depth / drop report (0 = off)
+
+    PipelineConfig();
+};
+
+// Where per-frame results go; see sinks.h
+struct OutputConfig {
+    bool display;                      // annotated frames in a HighGUI window
+    std::vector<std::string> records;  // "jsonl:<dest>" or "bin:<dest>", dest = stdout | unix:<path> | file
+    std::string video_path;            // annotated video file ("" = none)
+
+    OutputConfig();
+};
+
+// Wall time of each detect() stage, in milliseconds
+struct StageTimings {
+    double preprocess_ms;
+    double forward_ms;
+    double parse_ms;
+    double nms_ms;
+
+    StageTimings();
+};
+
+// Wall time of detector construction, in milliseconds
+struct StartupTimings {
+    double map_ms;           // opening / mapping the model files (0 for clones)
+    double parse_ms;         // building the network from the mapped bytes
+    double warmup_ms;        // first forward pass
+    double total_ms;
+
+    StartupTimings();
+};
+
+class ModelSource;
+class MetricCounter;
+
 // Main YOLO detector class
 class YOLODetector {
 private:
     cv::dnn::Net net;
     YOLOConfig config;
+    std::shared_ptr<const ModelSource> model;  // mapped model files, shared with clones
     std::vector<std::string> output_layer_names;
+    bool onnx_model;         // ONNX exports emit boxes in input pixels, not normalized
     
     // Pre-allocated containers for efficiency
     cv::Mat blob;
+    FusedPreprocessor preprocessor;
+    BoxSuppressor suppressor;
+    std::vector<LetterboxTransform> transforms;
     std::vector<cv::Mat> outputs;
     std::vector<int> class_ids;
     std::vector<float> confidences;
     std::vector<cv::Rect> boxes;
     std::vector<int> indices;
+    std::vector<float> best_scores;   // anchor-free decoding scratch
+    std::vector<float> best_classes;
+    // Networks of the other input sizes used so far, kept warm for instant switches
+    std::map<std::pair<int, int>, cv::dnn::Net> size_nets;
+    std::vector<MetricCounter*> class_counters;  // yolo_detections_total per class id
+    StageTimings timings;
+    StartupTimings startup;
     
-    void parseOutputs(const std::vector<cv::Mat>& outputs, cv::Size image_size);
+    YOLODetector(const YOLOConfig& cfg, std::shared_ptr<const ModelSource> source);
+    void configureBackend();
+    void warmup();
+    void prepareBlob(const std::vector<cv::Mat>& images);
+    void parseOutputs(const std::vector<cv::Mat>& outputs, const LetterboxTransform& transform,
+                      int batch_index, int batch_size);
+    std::vector<Detection> postprocess(const LetterboxTransform& transform, int batch_index, int batch_size);
+    void recordTimings(size_t images) const;
     
 public:
     YOLODetector(const YOLOConfig& cfg);
+    // Another detector on the same model files, e.g. for a parallel worker: no disk
+    // reads, and the resolved backend / target are reused
+    std::unique_ptr<YOLODetector> clone() const;
     std::vector<Detection> detect(const cv::Mat& image);
+    // Detects inside roi of image without copying it; boxes are in full-image coordinates
+    std::vector<Detection> detect(const cv::Mat& image, const cv::Rect& roi);
+    // Runs all images through a single forward pass; results are in input order
+    std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& images);
+    // Changes the network input size (rounded to a multiple of 32). Every size gets its
+    // own network built from the shared model and warmed up once, so switching back and
+    // forth costs nothing after the first time. Returns false if the model rejects it.
+    bool setInputSize(const cv::Size& size);
+    // Builds and warms the network for size ahead of time, keeping the current size
+    bool prepareInputSize(const cv::Size& size);
     float getConfidenceThreshold() const { return config.confidence_threshold; }
+    const YOLOConfig& getConfig() const { return config; }
+    // Stage breakdown of the most recent detect() / detectBatch() call
+    const StageTimings& getLastTimings() const { return timings; }
+    const StartupTimings& getStartupTimings() const { return startup; }
 };
 
 // Utility functions namespace
@@ -59,15 +191,35 @@ namespace YOLOUtils {
     std::vector<std::string> loadClassNames(const std::string& filename);
     void drawDetections(cv::Mat& image, const std::vector<Detection>& detections);
     void drawFPS(cv::Mat& image, double fps);
+    
+    // Target "auto": cpu_fp16 where the CPU has native FP16 arithmetic, cpu otherwise
+    const int AUTO_TARGET = -1;
+    bool cpuSupportsFp16();
+    bool isOnnxModel(const std::string& path);
+    
+    // Backend / target names as used on the command line, e.g. "openvino", "cpu_fp16"
+    int parseBackend(const std::string& name);
+    int parseTarget(const std::string& name);
+    std::string backendName(int backend);
+    std::string targetName(int target);
+    // Parses a CPU list such as "0-3,6"
+    std::vector<int> parseCpuList(const std::string& list);
+    // Pins the calling thread (and threads it starts later) to the given CPUs
+    bool setCpuAffinity(const std::vector<int>& cpus);
 }
 
 // Function to run inference on an image
-void run_image_inference(const std::string& image_path, YOLODetector& detector);
+void run_image_inference(const std::string& image_path, YOLODetector& detector,
+                         const OutputConfig& output_config = OutputConfig());
 
 // Function to run inference on a camera stream
-void run_camera_inference(int camera_index, YOLODetector& detector, int num_skipped_frames=5);
+void run_camera_inference(int camera_index, YOLODetector& detector,
+                          const PipelineConfig& pipeline_config = PipelineConfig(),
+                          const OutputConfig& output_config = OutputConfig());
 
-void run_rtsp_inference(const std::string& rtsp_url, YOLODetector& detector, int num_skipped_frames=5, 
+void run_rtsp_inference(const std::string& rtsp_url, YOLODetector& detector,
                         bool intrusion_feature = false, 
-                        const std::string& boxes_json_path = "/home/thanhvl/Documents/Works/YOLO-DarkNet-CPP-Inference/features/boxes.json");
+                        const std::string& zones_json_path = "/home/thanhvl/Documents/Works/YOLO-DarkNet-CPP-Inference/features/boxes.json",
+                        const PipelineConfig& pipeline_config = PipelineConfig(),
+                        const OutputConfig& output_config = OutputConfig());
 #endif // YOLO_DETECTOR_H
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef INPUT_SIZE_H
+#define INPUT_SIZE_H
+
+#include "inference.h"
+#include <atomic>
+#include <string>
+
+// Rounds both sides to the nearest multiple of 32 (the largest YOLO stride), at least 32
+cv::Size alignInputSize(const cv::Size& size);
+// Parses "416" or "640x384"; the result is aligned
+bool parseInputSize(const std::string& text, cv::Size& size);
+
+// Chooses the input size of one stream from what the detector finds. The stream
+// runs at small_size until an object shows up that is below min_object_px at that
+// size, then at large_size until hold_frames detector runs pass without one. Every
+// probe_interval runs a probe at large_size looks for objects too small to be found
+// at small_size at all; a probe that finds none goes straight back down. With a
+// latency budget large_size is abandoned as soon as its forward pass is slower than
+// the budget, measured afresh on every switch up. current() may be read from any
+// thread; update() is called in frame order from one thread.
+class InputSizeController {
+private:
+    InputSizeConfig config;
+    std::atomic<bool> use_large;
+    std::atomic<uint64_t> switch_count;
+    int runs_at_size;        // detector runs since the last switch
+    int quiet_runs;          // runs at large_size without a small object
+    bool probing;            // at large_size for a probe only
+    double large_forward_ms; // smoothed forward time at large_size
+
+    void select(bool large);
+
+public:
+    explicit InputSizeController(const InputSizeConfig& cfg);
+
+    cv::Size current() const { return use_large ? config.large_size : config.small_size; }
+    bool enabled() const { return config.auto_select; }
+    uint64_t switches() const { return switch_count; }
+
+    // Feeds one detector run made at input_size on a frame of frame_size
+    // (forward_ms = 0 if unknown)
+    void update(const std::vector<Detection>& detections, const cv::Size& frame_size,
+                const cv::Size& input_size, double forward_ms);
+};
+
+#endif // INPUT_SIZE_H
@@ -0,0 +1,47 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "bounded_queue.h"
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+
+enum class LogLevel { Debug = 0, Info = 1, Warning = 2, Error = 3 };
+
+// Process-wide logger. Callers only format and enqueue; a background thread does
+// the console I/O, so logging never blocks the capture or inference threads. If
+// the queue overflows the oldest lines are dropped rather than stalling callers.
+class AsyncLogger {
+public:
+    static AsyncLogger& instance();
+
+    void setLevel(LogLevel level) { min_level = static_cast<int>(level); }
+    bool enabled(LogLevel level) const { return static_cast<int>(level) >= min_level; }
+    void log(LogLevel level, const std::string& message);
+    // Stops the writer thread after everything queued has been written
+    void shutdown();
+
+    ~AsyncLogger();
+
+private:
+    BoundedQueue<std::string> lines;
+    std::atomic<int> min_level;
+    std::thread writer;
+
+    AsyncLogger();
+    void writerLoop();
+};
+
+// Formats the message only when the level is enabled, e.g.
+//   YOLO_LOG(LogLevel::Debug, "Detected " << n << " objects");
+#define YOLO_LOG(level, expr)                                          \
+    do {                                                               \
+        if (AsyncLogger::instance().enabled(level)) {                  \
+            std::ostringstream yolo_log_stream;                        \
+            yolo_log_stream << expr;                                   \
+            AsyncLogger::instance().log(level, yolo_log_stream.str()); \
+        }                                                              \
+    } while (0)
+
+#endif // LOGGER_H
@@ -0,0 +1,140 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Label pairs of one time series, e.g. {{"stream", "gate"}}
+typedef std::vector<std::pair<std::string, std::string>> MetricLabels;
+
+// Monotonic count. inc() is a single relaxed atomic add.
+class MetricCounter {
+public:
+    MetricCounter() : value(0) {}
+    void inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value;
+};
+
+// Value that can go up and down, such as a queue depth
+class MetricGauge {
+public:
+    MetricGauge() : value(0) {}
+    void set(double v) { value.store(v, std::memory_order_relaxed); }
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value;
+};
+
+// Fixed-bucket histogram. observe() scans the few bucket bounds and does two
+// relaxed atomic adds; the sum is kept in microunits so it stays an integer.
+class MetricHistogram {
+public:
+    explicit MetricHistogram(const std::vector<double>& upper_bounds);
+    void observe(double v);
+
+    const std::vector<double>& bounds() const { return upper; }
+    // Per-bucket (not cumulative) counts; the last bucket is +Inf
+    std::vector<uint64_t> bucketCounts() const;
+    uint64_t count() const;
+    double sum() const { return sum_micro.load(std::memory_order_relaxed) * 1e-6; }
+
+private:
+    std::vector<double> upper;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;  // upper.size() + 1
+    std::atomic<uint64_t> sum_micro;
+};
+
+// Bucket bounds in milliseconds for stage and end-to-end latencies
+std::vector<double> latencyBucketsMs();
+
+// Process-wide set of metrics. Registration takes a lock and is meant for setup;
+// callers keep the returned reference and update it lock-free on the hot path.
+// Registering the same name and labels again returns the existing metric.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    MetricCounter& counter(const std::string& name, const std::string& help,
+                           const MetricLabels& labels = MetricLabels());
+    MetricGauge& gauge(const std::string& name, const std::string& help,
+                       const MetricLabels& labels = MetricLabels());
+    MetricHistogram& histogram(const std::string& name, const std::string& help,
+                               const MetricLabels& labels = MetricLabels(),
+                               const std::vector<double>& bounds = latencyBucketsMs());
+
+    // Prometheus text exposition format, version 0.0.4
+    std::string prometheusText() const;
+    // {"timestamp_ms":..., "metrics":{"name":[{"labels":{...},"value":...}, ...]}};
+    // histograms carry "count", "sum" and per-bucket (not cumulative) "buckets"
+    std::string json() const;
+
+private:
+    struct Series {
+        MetricLabels labels;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+    struct Family {
+        std::string help;
+        std::string type;  // "counter", "gauge" or "histogram"
+        std::map<std::string, Series> series;  // keyed by the rendered label set
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, Family> families;
+
+    MetricsRegistry() {}
+    Series& series(const std::string& name, const std::string& help, const std::string& type,
+                   const MetricLabels& labels);
+};
+
+// Where and how often the registry is published
+struct MetricsConfig {
+    int http_port;             // serves GET /metrics (0 = off)
+    std::string json_path;     // periodic JSON dump ("" = off)
+    double json_interval_sec;
+
+    MetricsConfig();
+};
+
+// Publishes MetricsRegistry::instance(): a minimal HTTP/1.0 server answering
+// GET /metrics for Prometheus, and a thread that rewrites a JSON snapshot file
+// (write to a temporary file, then rename, so readers never see half a file).
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const MetricsConfig& cfg);
+    ~MetricsExporter();
+
+    // Returns false if the HTTP port cannot be bound
+    bool start();
+    void stop();
+
+private:
+    MetricsConfig config;
+    std::atomic<bool> running;
+    int listen_fd;
+    std::thread http_thread;
+    std::thread dump_thread;
+    std::mutex dump_mutex;
+    std::condition_variable dump_wakeup;
+
+    void httpLoop();
+    void serveClient(int client_fd);
+    void dumpLoop();
+    void writeJson();
+};
+
+#endif // METRICS_H
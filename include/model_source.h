@@ -0,0 +1,54 @@
+#ifndef MODEL_SOURCE_H
+#define MODEL_SOURCE_H
+
+#include <opencv2/dnn.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read-only bytes of a file: memory-mapped on Linux, read into memory elsewhere
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+private:
+    const char* bytes;
+    size_t length;
+    bool mapped;
+    std::vector<char> buffer;  // fallback copy when mmap is unavailable
+};
+
+// Model files opened once and shared by every detector built from them. Networks
+// are parsed straight from the mapped bytes, so clones never touch the disk and
+// the page cache holds a single copy of the weights for the whole process.
+// cv::dnn::Net is not thread-safe, so each detector still gets its own Net.
+class ModelSource {
+public:
+    // Maps the model and, for Darknet, its .cfg. A file that cannot be mapped is
+    // left to OpenCV's path-based readers, which report the error.
+    static std::shared_ptr<const ModelSource> open(const std::string& model_path,
+                                                   const std::string& config_path);
+
+    cv::dnn::Net createNet() const;
+    bool isOnnx() const { return onnx; }
+    size_t sizeBytes() const { return model.size() + config.size(); }
+
+private:
+    std::string model_path;
+    std::string config_path;
+    bool onnx;
+    MappedFile model;
+    MappedFile config;
+
+    ModelSource();
+};
+
+#endif // MODEL_SOURCE_H
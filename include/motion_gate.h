@@ -0,0 +1,52 @@
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <mutex>
+
+// Settings of the motion-gated inference scheduler
+struct MotionGateConfig {
+    bool enabled;            // false = run the detector on every frame
+    int analysis_width;      // width of the grayscale copy used for differencing
+    int pixel_threshold;     // intensity change (0-255) that counts a pixel as moving
+    double motion_ratio;     // fraction of moving pixels that triggers inference
+    double max_staleness_ms; // run inference at least this often, even on a static scene
+
+    MotionGateConfig();
+};
+
+// Decides per frame whether the detector has to run. Each frame is downscaled to a
+// small grayscale image and compared with the one the detector last saw, so slow
+// changes accumulate until they trigger instead of slipping under the threshold
+// frame by frame. Frames that do not trigger can reuse the previous detections.
+//
+// Testing and committing are separate steps: a triggered frame only becomes the
+// reference once the detector has really run it. A triggered frame dropped by a
+// full queue therefore leaves the change pending, and the next frame triggers.
+class MotionGate {
+private:
+    MotionGateConfig config;
+    cv::Mat small;
+    cv::Mat diff;
+    double last_motion;
+
+    std::mutex mutex;  // test() runs on the capture thread, commit() on the workers
+    cv::Mat reference;  // analysis image of the last frame the detector ran
+    int64_t last_detect_ticks;
+    uint64_t reference_index;
+    bool has_reference;
+
+public:
+    explicit MotionGate(const MotionGateConfig& cfg = MotionGateConfig());
+
+    // True when the frame must go through the detector. sample receives the frame's
+    // analysis image, to be passed to commit() once the detector has run the frame.
+    bool test(const cv::Mat& frame, cv::Mat& sample);
+    // Makes a detected frame the reference; older frames than the reference are ignored
+    void commit(const cv::Mat& sample, uint64_t index, int64_t capture_ticks);
+    // Fraction of moving pixels measured by the last test()
+    double lastMotion() const { return last_motion; }
+};
+
+#endif // MOTION_GATE_H
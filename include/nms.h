@@ -0,0 +1,60 @@
+#ifndef NMS_H
+#define NMS_H
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+// Suppression rule applied between overlapping candidates
+enum class NmsMethod {
+    Hard,   // greedy NMS on IoU, like cv::dnn::NMSBoxes
+    Soft,   // Gaussian Soft-NMS: overlapping scores decay instead of being dropped
+    DIoU    // greedy NMS on IoU minus the normalized centre distance
+};
+
+// "hard", "soft" or "diou"; unknown names fall back to hard
+NmsMethod parseNmsMethod(const std::string& name);
+const char* nmsMethodName(NmsMethod method);
+
+// Batched non-maximum suppression over the candidates of one image. Candidates are
+// capped to the top_k best scores with a partial selection and bucketed per class
+// with a counting pass. Nothing is sorted: each bucket picks its best box with a
+// linear scan and keeps its corners as structure of arrays, so the IoU of that box
+// against the rest of the bucket is computed with SIMD. Scratch buffers are kept
+// between calls.
+class BoxSuppressor {
+private:
+    NmsMethod method;
+    bool per_class;
+    int top_k;
+    float soft_sigma;
+
+    std::vector<int> order;        // candidates passing the score threshold
+    std::vector<int> grouped;      // the same candidates, grouped by class
+    std::vector<int> bucket_start; // offset of each class in `grouped`
+
+    // One bucket as structure of arrays; survivors are compacted to the front
+    std::vector<float> x1, y1, x2, y2, area;
+    std::vector<float> scores;     // decayed in place by Soft-NMS
+    std::vector<int> ids;          // candidate index of each slot
+    std::vector<float> overlap;    // IoU (or DIoU) of the selected box against the bucket
+
+    void suppressBucket(const std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                        const int* bucket, int count, float score_threshold,
+                        float iou_threshold, std::vector<int>& indices);
+    void computeOverlap(float bx1, float by1, float bx2, float by2, float barea, int count);
+
+public:
+    BoxSuppressor();
+    // top_k: candidates kept (best scores first) before suppression, 0 = all.
+    // per_class = false suppresses across classes like a single NMSBoxes call.
+    void configure(NmsMethod nms_method, bool per_class_nms, int max_candidates, float sigma);
+
+    // Appends the indices of the surviving boxes to `indices` (cleared first).
+    // Soft-NMS writes the decayed scores back into `confidences`.
+    void run(const std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+             const std::vector<int>& class_ids, float score_threshold, float iou_threshold,
+             std::vector<int>& indices);
+};
+
+#endif // NMS_H
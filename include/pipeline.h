@@ -0,0 +1,102 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "inference.h"
+#include "bounded_queue.h"
+#include "motion_gate.h"
+#include "tracker.h"
+#include "input_size.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+// Unit of work passed between pipeline stages
+struct FramePacket {
+    uint64_t index;
+    cv::Mat frame;
+    std::vector<Detection> detections;
+    bool run_detector;  // false: the motion gate saw no change, detections are predicted
+                        // by the tracker (or the last ones reused without tracking)
+    cv::Mat motion_sample;  // motion gate analysis image, committed once the detector ran
+    cv::Size input_size;  // network input size the detector ran at
+    double forward_ms;
+    int64_t capture_ticks;  // cv::getTickCount() when the frame was read
+
+    FramePacket() : index(0), run_detector(true), forward_ms(0), capture_ticks(0) {}
+};
+
+// Snapshot of pipeline counters and queue state
+struct PipelineStats {
+    uint64_t frames_captured;
+    uint64_t frames_processed;
+    uint64_t frames_rendered;
+    uint64_t late_frames;  // finished after a newer frame was already rendered
+    uint64_t frames_reused;   // rendered with predicted or previous detections (no motion)
+    uint64_t frames_drained;  // live frames replaced by a newer one before capture took them
+    uint64_t frame_allocations;  // capture buffers allocated (ring fill plus misses)
+    uint64_t input_size_switches;
+    cv::Size input_size;      // current network input size
+    size_t capture_queue_depth;
+    size_t capture_queue_drops;
+    size_t result_queue_depth;
+    size_t result_queue_drops;
+    IngestStats ingest;       // state and reconnects of the source
+    double fps;
+};
+
+// Capture thread -> N inference workers -> render stage on the caller's thread.
+// Rendering stays on the caller so HighGUI is only touched from one thread.
+class InferencePipeline {
+public:
+    // Invoked for every processed frame; return false to stop the pipeline
+    typedef std::function<bool(FramePacket&)> RenderCallback;
+
+    InferencePipeline(StreamIngestor& capture, YOLODetector& detector,
+                      const PipelineConfig& cfg);
+    ~InferencePipeline();
+
+    // Blocks until the source is exhausted or the render callback returns false
+    void run(const RenderCallback& render);
+    void stop();
+    PipelineStats getStats() const;
+    // Only valid on the render callback's thread
+    const MultiObjectTracker& getTracker() const { return tracker; }
+
+private:
+    StreamIngestor& source;
+    PipelineConfig config;
+    std::vector<YOLODetector*> detectors;
+    std::vector<std::unique_ptr<YOLODetector>> owned_detectors;
+
+    BoundedQueue<FramePacket> capture_queue;
+    BoundedQueue<FramePacket> result_queue;
+
+    std::atomic<bool> running;
+    std::atomic<int> active_workers;
+    std::atomic<uint64_t> frames_captured;
+    std::atomic<uint64_t> frames_processed;
+    std::atomic<uint64_t> frames_rendered;
+    std::atomic<uint64_t> late_frames;
+    std::atomic<uint64_t> frames_reused;
+    int64_t start_ticks;
+
+    // Tested on the capture thread, committed by the workers
+    MotionGate motion_gate;
+
+    // Owned by the render stage, which sees the frames in order; workers read the size
+    MultiObjectTracker tracker;
+    InputSizeController input_sizes;
+
+    std::thread capture_thread;
+    std::vector<std::thread> worker_threads;
+
+    void captureLoop();
+    void inferenceLoop(YOLODetector* detector);
+    void join();
+};
+
+void printPipelineStats(const PipelineStats& stats);
+
+#endif // PIPELINE_H
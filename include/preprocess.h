@@ -0,0 +1,54 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Placement of an image inside the network input. Stretch mode scales each axis
+// independently; letterbox keeps the aspect ratio and centres the image between
+// padding bars.
+struct LetterboxTransform {
+    cv::Size image_size;
+    cv::Size input_size;
+    cv::Size resized_size;  // area of the input covered by the image
+    float scale_x;          // input pixels per image pixel
+    float scale_y;
+    int pad_x;              // left / top padding in input pixels
+    int pad_y;
+
+    LetterboxTransform();
+    LetterboxTransform(cv::Size image, cv::Size input, bool letterbox);
+
+    // Maps a point from network input pixels back to image pixels
+    cv::Point2f toImage(float input_x, float input_y) const {
+        return cv::Point2f((input_x - pad_x) / scale_x, (input_y - pad_y) / scale_y);
+    }
+};
+
+// Bilinear resize, BGR->RGB swap, (x - mean) * scale and HWC->NCHW packing done in
+// one pass over the source pixels, writing straight into a float blob. The source
+// may be an ROI of a larger frame; nothing is copied or allocated per call.
+class FusedPreprocessor {
+private:
+    cv::Scalar mean;
+    float scale;
+    bool swap_rb;
+    float pad_value;
+
+    // Bilinear taps, reused between calls
+    std::vector<int> x_offsets;   // byte offsets of the two source pixels per output column
+    std::vector<float> x_weights;
+    std::vector<int> y_rows;      // the two source rows per output row
+    std::vector<float> y_weights;
+    cv::Mat converted;            // only used for non 3-channel input
+
+public:
+    FusedPreprocessor();
+    void configure(const cv::Scalar& mean_values, double scale_factor, bool swap_channels,
+                   float padding_value);
+
+    // Writes the 3 x H x W planes of one image into dst (H x W = transform.input_size)
+    void pack(const cv::Mat& image, const LetterboxTransform& transform, float* dst);
+};
+
+#endif // PREPROCESS_H
@@ -0,0 +1,130 @@
+#ifndef SINKS_H
+#define SINKS_H
+
+#include "inference.h"
+#include "zones.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// Everything a sink may need about one processed frame
+struct FrameResult {
+    std::string stream_id;
+    uint64_t frame_index;
+    int64_t timestamp_ms;   // wall clock, milliseconds since the epoch
+    cv::Size frame_size;
+    const std::vector<Detection>* detections;
+    bool intrusion;
+    const std::vector<ZoneEvent>* events;  // zone events of this frame, may be null
+    cv::Mat frame;          // annotated frame, only filled when a sink needs it
+
+    FrameResult();
+};
+
+// Byte destination shared by the record sinks: "stdout", "unix:<socket path>"
+// (connects to a listening SOCK_STREAM socket) or a file path
+class OutputStream {
+public:
+    OutputStream();
+    ~OutputStream();
+    bool open(const std::string& destination);
+    // Socket writes never block: a record that does not fit is dropped and counted
+    void write(const char* data, size_t size);
+    void flush();
+    uint64_t dropped() const { return dropped_records; }
+
+private:
+    FILE* file;
+    int socket_fd;
+    bool owns_file;
+    uint64_t dropped_records;
+};
+
+// Consumer of per-frame results
+class DetectionSink {
+public:
+    virtual ~DetectionSink() {}
+    // Returns false to ask the caller to stop (e.g. ESC in the display window)
+    virtual bool write(const FrameResult& result) = 0;
+    // Sinks that need the annotated frame; drawing is skipped when none does
+    virtual bool needsFrame() const { return false; }
+    virtual void flush() {}
+};
+
+// One JSON object per line:
+// {"stream":"cam","frame":12,"ts":1700000000000,"width":1920,"height":1080,
+//  "intrusion":false,"detections":[{"class_id":0,"class":"person","conf":0.91,
+//  "track_id":7,"box":[x,y,w,h]}],"events":[{"type":"enter","zone":"gate","track_id":7,
+//  "class":"person","dwell_ms":0}]}   (track_id is -1 for untracked detections)
+class JsonLinesSink : public DetectionSink {
+public:
+    explicit JsonLinesSink(const std::string& destination);
+    bool write(const FrameResult& result) override;
+    void flush() override { out.flush(); }
+
+private:
+    OutputStream out;
+    std::string line;
+};
+
+// Compact little-endian record per frame:
+//   u32 magic 'YDET', u32 payload size, u64 frame, i64 ts_ms, u16 width, u16 height,
+//   u8 intrusion, u8 stream id length, stream id bytes, u32 detection count,
+//   then per detection: i32 class_id, f32 confidence, i32 x, y, w, h, i32 track_id,
+//   then u32 event count and per event: u8 type (0 enter, 1 exit, 2 dwell),
+//   u8 zone id length, zone id bytes, i32 track_id, f32 dwell_ms
+class BinarySink : public DetectionSink {
+public:
+    explicit BinarySink(const std::string& destination);
+    bool write(const FrameResult& result) override;
+    void flush() override { out.flush(); }
+
+private:
+    OutputStream out;
+    std::vector<char> record;
+};
+
+// Writes the annotated frames to a video file
+class VideoWriterSink : public DetectionSink {
+public:
+    VideoWriterSink(const std::string& path, double fps);
+    bool write(const FrameResult& result) override;
+    bool needsFrame() const override { return true; }
+
+private:
+    std::string path;
+    double fps;
+    cv::VideoWriter writer;
+};
+
+// Shows the annotated frames in a HighGUI window; ESC stops the run
+class DisplaySink : public DetectionSink {
+public:
+    explicit DisplaySink(const std::string& window_name);
+    ~DisplaySink() override;
+    bool write(const FrameResult& result) override;
+    bool needsFrame() const override { return true; }
+
+private:
+    std::string window;
+};
+
+// Fan-out over all configured sinks
+class SinkSet {
+public:
+    void add(std::unique_ptr<DetectionSink> sink);
+    bool needsFrame() const;
+    bool empty() const { return sinks.empty(); }
+    bool write(const FrameResult& result);
+    void flush();
+
+private:
+    std::vector<std::unique_ptr<DetectionSink>> sinks;
+};
+
+// Builds the sinks described by an OutputConfig; window_name is used when display is on
+void createSinks(const OutputConfig& config, const std::string& window_name, double fps,
+                 SinkSet& sinks);
+
+#endif // SINKS_H
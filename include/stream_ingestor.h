@@ -0,0 +1,108 @@
+#ifndef STREAM_INGESTOR_H
+#define STREAM_INGESTOR_H
+
+#include "capture.h"
+#include "metrics.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Reconnect and buffering policy of a StreamIngestor
+struct IngestConfig {
+    int reconnect_initial_ms;  // first retry delay, doubled after every failed attempt
+    int reconnect_max_ms;      // backoff ceiling
+    int max_reconnects;        // failed attempts in a row before giving up (0 = never)
+    int stall_timeout_ms;      // no frame for this long marks the stream unhealthy
+    bool latest_only;          // live sources: keep only the newest decoded frame
+
+    IngestConfig();
+};
+
+enum class IngestState { Connecting, Streaming, Reconnecting, Ended, Failed };
+
+const char* ingestStateName(IngestState state);
+
+// Health of one source
+struct IngestStats {
+    IngestState state;
+    uint64_t frames_grabbed;
+    uint64_t frames_delivered;
+    uint64_t frames_overwritten;  // replaced by a newer frame before anyone read them
+    uint64_t reconnects;
+    double last_frame_age_ms;     // since the newest frame was decoded (-1 = none yet)
+    double delivery_age_ms;       // decode-to-read age of delivered frames, smoothed
+    bool healthy;                 // streaming and a frame within stall_timeout_ms
+
+    IngestStats();
+};
+
+// Reads one source and survives it going away. Live sources (network URLs and
+// cameras) are decoded on a grabber thread that keeps only the newest frame, so
+// a slow consumer sees fresh frames instead of a growing FFmpeg backlog. When a
+// read fails or times out (CaptureConfig::read_timeout_ms) the source is reopened
+// with exponential backoff and jitter. Files are read on the caller's thread,
+// frame by frame, and simply end.
+class StreamIngestor {
+public:
+    StreamIngestor(const std::string& source, const CaptureConfig& capture,
+                   const IngestConfig& cfg, const std::string& stream_id);
+    ~StreamIngestor();
+
+    // Opens the source once. A file that cannot be opened fails; a live source
+    // that is down keeps being retried in the background.
+    bool start();
+    // Next frame newer than the last one returned. False on timeout (timeout_ms,
+    // -1 = wait) or once the source has ended or failed; see finished().
+    bool read(cv::Mat& frame, int timeout_ms = -1);
+    void stop();
+
+    bool live() const { return is_live; }
+    bool finished() const;
+    // Frame rate reported by the source when it was last opened (0 = unknown)
+    double fps() const { return source_fps; }
+    uint64_t frameAllocations() const { return cap.frameAllocations(); }
+    IngestStats getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::string source;
+    std::string id;
+    IngestConfig config;
+    VideoSource cap;
+    bool is_live;
+
+    mutable std::mutex mutex;
+    std::condition_variable frame_ready;  // also wakes backoff waits on stop()
+    std::thread grabber;
+    bool running;
+    IngestState state;
+    cv::Mat newest;
+    uint64_t newest_seq;
+    uint64_t delivered_seq;
+    Clock::time_point newest_time;
+    std::atomic<double> source_fps;
+
+    uint64_t frames_grabbed;
+    uint64_t frames_delivered;
+    uint64_t frames_overwritten;
+    uint64_t reconnects;
+    double delivery_age_ms;
+
+    MetricCounter& frames_metric;
+    MetricCounter& overwritten_metric;
+    MetricCounter& reconnects_metric;
+    MetricGauge& healthy_metric;
+    MetricHistogram& age_metric;
+
+    bool openSource();
+    void grabLoop();
+    // Sleeps for the backoff delay unless stop() comes first; false when stopped
+    bool backoff(int delay_ms);
+    void setState(IngestState next);
+};
+
+#endif // STREAM_INGESTOR_H
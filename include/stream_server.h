@@ -0,0 +1,101 @@
+#ifndef STREAM_SERVER_H
+#define STREAM_SERVER_H
+
+#include "inference.h"
+#include "batch_dispatcher.h"
+#include "input_size.h"
+#include "metrics.h"
+#include "stream_ingestor.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// One entry of the stream manifest
+struct StreamSpec {
+    std::string id;
+    std::string url;  // RTSP/HTTP URL, video file or camera index
+    std::string zones_path;  // zone file of this camera (empty = no zones)
+    InputSizeConfig input_size;  // empty large_size = the detector's input size
+};
+
+// Multi-stream server configuration, usually read from a JSON manifest
+struct ServerConfig {
+    std::vector<StreamSpec> streams;
+    int num_detectors;          // detectors (and inference threads) shared by all streams
+    BatchConfig batch;
+    double stats_interval_sec;  // period of the per-stream report (0 = off)
+    bool tracking;              // per-stream track ids in the records
+    CaptureConfig capture;      // decoding backend shared by all streams
+    IngestConfig ingest;        // reconnect backoff of network streams
+
+    ServerConfig();
+};
+
+// Reads a manifest such as
+// { "detectors": 2, "max_batch": 4, "max_wait_ms": 10, "tracking": true,
+//   "capture_backend": "ffmpeg", "hw_decode": true, "decode_threads": 2,
+//   "streams": [ { "id": "gate", "url": "rtsp://...", "zones": "zones/gate.json",
+//                  "input_size": "auto" }, ... ] }
+// where "input_size" is a fixed size (416 or "640x384") or "auto".
+// Returns false if the file cannot be read or lists no streams.
+bool loadStreamManifest(const std::string& filename, ServerConfig& config);
+
+// Per-stream counters, updated by the reader thread and the inference workers
+struct StreamState {
+    StreamSpec spec;
+    std::atomic<uint64_t> frames_read;
+    std::atomic<uint64_t> frames_processed;
+    std::atomic<uint64_t> late_results;  // finished after a newer frame of the same stream
+    std::atomic<uint64_t> last_delivered;
+    std::atomic<bool> finished;
+    std::unique_ptr<StreamIngestor> ingest;  // reconnects, health and the newest frame
+    InputSizeController input_sizes;
+    // Same counts labelled by stream id in the metrics registry
+    MetricCounter& frames_read_total;
+    MetricCounter& frames_processed_total;
+    MetricCounter& late_results_total;
+    std::mutex input_size_mutex;  // guards input_sizes.update()
+
+    StreamState(const StreamSpec& stream_spec, const CaptureConfig& capture, const IngestConfig& ingest_config);
+};
+
+// Opens every stream of the manifest on its own reader thread and schedules the
+// frames round-robin onto a fixed pool of detectors through a BatchDispatcher.
+// Readers never wait for inference: each stream keeps at most its newest frame
+// pending, so a slow or dead stream cannot hold up the others.
+class StreamServer {
+public:
+    // Called on an inference thread with each stream's results, in frame order
+    typedef std::function<void(const StreamState& stream, uint64_t frame_index,
+                               const cv::Mat& frame, std::vector<Detection>& detections)> ResultHandler;
+
+    StreamServer(YOLODetector& detector, const ServerConfig& cfg);
+    ~StreamServer();
+
+    // Blocks until every stream has ended or stop() is called
+    void run(const ResultHandler& handler);
+    void stop();
+    void printStats() const;
+
+private:
+    ServerConfig config;
+    std::vector<std::unique_ptr<YOLODetector>> owned_detectors;
+    std::vector<YOLODetector*> detectors;
+    std::unique_ptr<BatchDispatcher> dispatcher;
+    std::vector<std::unique_ptr<StreamState>> streams;
+    std::vector<std::thread> readers;
+    std::atomic<bool> running;
+    ResultHandler on_result;
+
+    void readerLoop(int source_id);
+};
+
+// Server mode entry point used by main: runs the manifest's streams headless and
+// writes the results to the record sinks of output_config
+void run_stream_server(const std::string& manifest_path, YOLODetector& detector,
+                       const OutputConfig& output_config = OutputConfig());
+
+#endif // STREAM_SERVER_H
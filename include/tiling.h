@@ -0,0 +1,50 @@
+#ifndef TILING_H
+#define TILING_H
+
+#include "inference.h"
+#include "nms.h"
+#include <memory>
+#include <vector>
+
+// Overlapping tiles of tile_size covering area. Tiles are spread evenly so the last
+// one ends on the area's edge; an area smaller than a tile yields a single tile
+// clipped to the frame.
+std::vector<cv::Rect> makeTiles(const cv::Rect& area, const cv::Size& tile_size, float overlap,
+                                const cv::Size& frame_size);
+
+// Sliced inference: the frame (or only its regions of interest) is cut into
+// overlapping tiles at native resolution, the tiles are run as batches through
+// detectBatch(), optionally on several detectors in parallel, and the boxes are
+// shifted back to frame coordinates and merged across the tile seams with NMS.
+// The tiles are ROI headers onto the frame, so nothing is copied.
+class TiledDetector {
+private:
+    YOLODetector& detector;
+    TilingConfig config;
+    std::vector<std::unique_ptr<YOLODetector>> owned_detectors;
+    std::vector<YOLODetector*> detectors;
+    std::vector<cv::Rect> regions;
+    BoxSuppressor merger;
+
+    // Tile layout, rebuilt when the frame size changes
+    cv::Size layout_size;
+    std::vector<cv::Rect> tiles;
+
+    // Merge buffers, reused between frames
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confidences;
+    std::vector<int> class_ids;
+    std::vector<int> indices;
+
+    void buildLayout(const cv::Size& frame_size);
+
+public:
+    TiledDetector(YOLODetector& base_detector, const TilingConfig& cfg);
+
+    // Restricts tiling to these frame regions (empty = the whole frame)
+    void setRegions(const std::vector<cv::Rect>& rois);
+    std::vector<Detection> detect(const cv::Mat& frame);
+    size_t tileCount() const { return tiles.size(); }
+};
+
+#endif // TILING_H
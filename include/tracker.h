@@ -0,0 +1,76 @@
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include "inference.h"
+#include <opencv2/video.hpp>
+#include <vector>
+
+// Association and lifetime settings of the tracker
+struct TrackerConfig {
+    float match_iou;        // minimum IoU between a track's prediction and a detection
+    float high_confidence;  // detections above this start tracks and are matched first
+    int min_hits;           // matched detections before a track gets an id
+    int max_age;            // detection rounds a track survives without a match
+    bool class_aware;       // only match detections of the track's class
+
+    TrackerConfig();
+};
+
+// SORT / ByteTrack style multi-object tracker. Each track runs a constant velocity
+// Kalman filter over (cx, cy, w, h). Detections are assigned to the predicted boxes
+// with the Hungarian algorithm on 1 - IoU, confident detections first and the rest
+// against the tracks left over. Between detector runs the filters are only advanced,
+// which yields per-frame boxes while the forward pass runs at a fraction of the
+// frame rate.
+class MultiObjectTracker {
+private:
+    struct Track {
+        int id;                // 0 until the track is confirmed
+        int class_id;
+        std::string class_name;
+        float confidence;
+        cv::KalmanFilter filter;
+        cv::Rect predicted;
+        int hits;
+        int misses;            // detection rounds since the last match
+    };
+
+    TrackerConfig config;
+    std::vector<Track> tracks;
+    int next_id;
+
+    // Scratch buffers for the association, reused between frames
+    std::vector<double> cost;
+    std::vector<int> assignment;
+    std::vector<int> open_tracks;
+    std::vector<int> confident;
+    std::vector<int> weak;
+    std::vector<int> unmatched;
+    std::vector<int> discarded;
+    cv::Mat measurement;
+
+    void advance(int frames);
+    // Matches detections[detection_indices] against tracks[open]; matched tracks are
+    // corrected and removed from open, unmatched detections are returned
+    void associate(std::vector<Detection>& detections, const std::vector<int>& detection_indices,
+                   std::vector<int>& open, std::vector<int>& unmatched_detections);
+    void correct(Track& track, Detection& detection);
+    void startTrack(Detection& detection);
+
+public:
+    explicit MultiObjectTracker(const TrackerConfig& cfg = TrackerConfig());
+
+    // Frame with fresh detections: sets track_id on the detections that belong to a
+    // confirmed track (-1 otherwise) and updates the tracks. elapsed_frames is the
+    // distance to the previous call when frames were dropped in between.
+    void update(std::vector<Detection>& detections, int elapsed_frames = 1);
+    // Frame without inference: advances the tracks and returns the predicted boxes of
+    // the confirmed tracks that matched in the last detection round
+    std::vector<Detection> predict(int elapsed_frames = 1);
+
+    size_t activeTracks() const { return tracks.size(); }
+    // Number of ids handed out so far, i.e. unique objects seen
+    int uniqueTracks() const { return next_id - 1; }
+};
+
+#endif // TRACKER_H
@@ -0,0 +1,37 @@
+#ifndef YOLO_DECODE_H
+#define YOLO_DECODE_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+#include "preprocess.h"
+
+// Decoding of raw YOLO output rows: [cx, cy, w, h, objectness, class scores...].
+// Rows whose objectness and best class score pass conf_threshold are appended to
+// boxes / confidences / class_ids; coordinates are normalized and mapped back
+// to the original image through the preprocessing transform.
+
+// SIMD path: objectness is gathered for a whole block of rows at once so blocks
+// without a single candidate are skipped, and the class argmax is vectorized
+void decodeYoloRows(const float* data, int rows, int cols, float conf_threshold,
+                    const LetterboxTransform& transform, std::vector<cv::Rect>& boxes,
+                    std::vector<float>& confidences, std::vector<int>& class_ids);
+
+// Plain row-by-row reference implementation with identical results
+void decodeYoloRowsScalar(const float* data, int rows, int cols, float conf_threshold,
+                          const LetterboxTransform& transform, std::vector<cv::Rect>& boxes,
+                          std::vector<float>& confidences, std::vector<int>& class_ids);
+
+// Anchor-free outputs (YOLOv8 style ONNX exports): a channels x anchors matrix with
+// rows cx, cy, w, h and one row per class, without objectness. The per-anchor best
+// class is reduced row by row so every load is contiguous; best_scores and
+// best_classes are scratch buffers reused between calls.
+void decodeAnchorFreeColumns(const float* data, int channels, int anchors, float conf_threshold,
+                             const LetterboxTransform& transform, std::vector<cv::Rect>& boxes,
+                             std::vector<float>& confidences, std::vector<int>& class_ids,
+                             std::vector<float>& best_scores, std::vector<float>& best_classes);
+
+// The decoders take normalized coordinates; ONNX exports give network input pixels,
+// which this transform maps back to the image instead
+LetterboxTransform inputPixelTransform(const LetterboxTransform& transform);
+
+#endif // YOLO_DECODE_H
@@ -0,0 +1,122 @@
+#ifndef ZONES_H
+#define ZONES_H
+
+#include "inference.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Which part of a detection has to be inside a zone
+enum class ZoneAnchor {
+    BottomCenter,  // the object's foot point, the usual choice for ground zones
+    Center,
+    Overlap        // any overlap between the box and the zone (legacy boxes.json)
+};
+
+// Polygon zone with an optional class filter
+struct Zone {
+    std::string id;
+    std::vector<cv::Point2f> polygon;
+    std::vector<int> class_ids;  // classes the zone reacts to (empty = all)
+    ZoneAnchor anchor;
+    double min_dwell_ms;         // stay needed before a dwell event (0 = no dwell events)
+    cv::Rect bounds;             // filled by the engine
+
+    Zone();
+    bool acceptsClass(int class_id) const;
+};
+
+enum class ZoneEventType { Enter, Exit, Dwell };
+
+const char* zoneEventName(ZoneEventType type);
+
+// Per-zone event of one tracked object
+struct ZoneEvent {
+    ZoneEventType type;
+    std::string zone_id;
+    int track_id;
+    int class_id;
+    std::string class_name;
+    double dwell_ms;        // time spent in the zone so far
+};
+
+// Reads zones from JSON. Two formats are accepted:
+//   { "zones": [ { "id": "gate", "polygon": [[x, y], ...], "classes": ["person", 2],
+//                  "anchor": "bottom" | "center" | "overlap", "min_dwell_ms": 2000 } ] }
+// and the legacy boxes.json list [ { "x1": .., "y1": .., "x2": .., "y2": .. } ], whose
+// rectangles become overlap zones. Class names are resolved with class_names.
+bool loadZones(const std::string& path, const std::vector<std::string>& class_names,
+               std::vector<Zone>& zones);
+
+// Evaluates detections against many zones. Zone bounding boxes are binned into a
+// uniform grid once, so a detection is only tested against the few zones whose
+// cells it touches; the polygon test runs on precomputed edges. Objects with a
+// track id produce enter / exit / dwell events; untracked ones only count for
+// occupancy. The zone file is watched and reloaded when it changes.
+class ZoneEngine {
+private:
+    struct Edge {
+        float x0, y0, x1, y1;
+    };
+    struct Presence {
+        int64_t entered_ms;
+        int64_t last_seen_ms;
+        int class_id;
+        std::string class_name;
+        bool dwell_reported;
+    };
+
+    std::vector<Zone> zone_list;
+    std::vector<std::vector<Edge>> zone_edges;
+    std::vector<bool> zone_is_rect;
+    std::vector<bool> occupied;
+    bool has_overlap_zones;
+
+    // Grid index in CSR form: zones of cell c are cell_zones[cell_start[c] .. cell_start[c + 1])
+    cv::Rect grid_area;
+    int cell_size;
+    int grid_cols;
+    int grid_rows;
+    std::vector<int> cell_start;
+    std::vector<int> cell_zones;
+    std::vector<int> visited;  // per-zone stamp so a zone is tested once per detection
+    int visit_stamp;
+
+    // (zone index, track id) -> presence
+    std::map<std::pair<int, int>, Presence> presences;
+
+    std::string source_path;
+    std::vector<std::string> class_names;
+    int64_t source_stamp;  // modification time and size of the zone file
+    int64_t last_reload_check_ms;
+    int64_t exit_grace_ms;
+
+    void buildIndex();
+    bool contains(int zone, const cv::Rect& box) const;
+    void matchDetection(const Detection& detection, int64_t now_ms, std::vector<ZoneEvent>& events);
+    void pushEvent(ZoneEventType type, int zone, int track_id, const Presence& presence,
+                   int64_t now_ms, std::vector<ZoneEvent>& events) const;
+
+public:
+    ZoneEngine();
+
+    // Loads the zones and remembers the file for reloadIfChanged(), also when it fails
+    bool load(const std::string& path, const std::vector<std::string>& names);
+    void setZones(const std::vector<Zone>& zones);
+    // Reloads the zone file if its modification time changed (checked at most once a second)
+    bool reloadIfChanged(int64_t now_ms);
+
+    // Evaluates one frame and appends its events; returns true if any zone is occupied
+    bool update(const std::vector<Detection>& detections, float min_confidence, int64_t now_ms,
+                std::vector<ZoneEvent>& events);
+
+    const std::vector<Zone>& zones() const { return zone_list; }
+    bool isOccupied(size_t zone) const { return zone < occupied.size() && occupied[zone]; }
+    bool empty() const { return zone_list.empty(); }
+    // Outlines the zones, occupied ones in red
+    void draw(cv::Mat& frame) const;
+};
+
+#endif // ZONES_H
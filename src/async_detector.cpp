@@ -0,0 +1,53 @@
+#include "async_detector.h"
+#include <algorithm>
+#include <stdexcept>
+
+// AsyncConfig struct implementation
+AsyncConfig::AsyncConfig()
+    : num_contexts(2), max_batch(4), max_wait_ms(2), max_pending(64) {}
+
+// AsyncDetector class implementation
+AsyncDetector::AsyncDetector(const YOLODetector& prototype, const AsyncConfig& cfg) {
+    std::vector<YOLODetector*> detectors;
+    for (int i = 0; i < std::max(1, cfg.num_contexts); ++i) {
+        contexts.push_back(prototype.clone());
+        detectors.push_back(contexts.back().get());
+    }
+    BatchConfig batch;
+    batch.max_batch = cfg.max_batch;
+    batch.max_wait_ms = cfg.max_wait_ms;
+    // Every request is answered: no per-source dropping, back-pressure instead
+    batch.per_source_capacity = 0;
+    batch.max_pending = cfg.max_pending;
+    dispatcher.reset(new BatchDispatcher(detectors, batch));
+}
+
+AsyncDetector::~AsyncDetector() {
+    shutdown();
+}
+
+std::future<std::vector<Detection>> AsyncDetector::detectAsync(const cv::Mat& image) {
+    // std::function needs a copyable target, so the promise is shared
+    auto promise = std::make_shared<std::promise<std::vector<Detection>>>();
+    std::future<std::vector<Detection>> result = promise->get_future();
+    bool accepted = dispatcher->submit(0, image,
+        [promise](std::vector<Detection>&& detections) { promise->set_value(std::move(detections)); },
+        cv::Size(),
+        [promise](std::exception_ptr error) { promise->set_exception(error); });
+    if (!accepted) {
+        promise->set_exception(std::make_exception_ptr(std::runtime_error("AsyncDetector is shut down")));
+    }
+    return result;
+}
+
+bool AsyncDetector::detectAsync(const cv::Mat& image, ResultCallback on_done, ErrorCallback on_error) {
+    return dispatcher->submit(0, image, std::move(on_done), cv::Size(), std::move(on_error));
+}
+
+void AsyncDetector::shutdown() {
+    dispatcher->stop();
+}
+
+BatchDispatcherStats AsyncDetector::getStats() const {
+    return dispatcher->getStats();
+}
@@ -0,0 +1,200 @@
+#include "batch_dispatcher.h"
+#include "logger.h"
+#include "metrics.h"
+
+namespace {
+
+// Process-wide dispatcher metrics, registered on first use
+struct DispatcherMetrics {
+    MetricHistogram& batch_size;
+    MetricHistogram& queue_wait_ms;
+    MetricCounter& dropped;
+
+    DispatcherMetrics()
+        : batch_size(MetricsRegistry::instance().histogram(
+              "yolo_batch_size", "Frames per detectBatch() call", MetricLabels(), {1, 2, 4, 8, 16, 32})),
+          queue_wait_ms(MetricsRegistry::instance().histogram(
+              "yolo_batch_wait_ms", "Time a frame waited for its batch in milliseconds")),
+          dropped(MetricsRegistry::instance().counter(
+              "yolo_batch_dropped_total", "Frames replaced by a newer frame of the same source")) {}
+
+    static DispatcherMetrics& get() {
+        static DispatcherMetrics metrics;
+        return metrics;
+    }
+};
+
+} // namespace
+
+// BatchConfig struct implementation
+BatchConfig::BatchConfig()
+    : max_batch(4), max_wait_ms(10), per_source_capacity(1), max_pending(0) {}
+
+BatchDispatcher::BatchDispatcher(const std::vector<YOLODetector*>& detectors,
+                                 const BatchConfig& cfg)
+    : config(cfg), last_source(-1), pending_count(0), stopping(false),
+      frames_submitted(0), frames_dropped(0), frames_processed(0), batches(0) {
+    if (config.max_batch < 1) config.max_batch = 1;
+    for (YOLODetector* detector : detectors) {
+        workers.emplace_back(&BatchDispatcher::workerLoop, this, detector);
+    }
+}
+
+BatchDispatcher::~BatchDispatcher() {
+    stop();
+}
+
+bool BatchDispatcher::submit(int source_id, const cv::Mat& frame, ResultCallback on_done,
+                             const cv::Size& input_size, ErrorCallback on_error) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (config.max_pending > 0) {
+            space_ready.wait(lock, [this] { return stopping || pending_count < config.max_pending; });
+        }
+        if (stopping) {
+            return false;
+        }
+        std::deque<Request>& queue = pending[source_id];
+        if (config.per_source_capacity > 0 && queue.size() >= config.per_source_capacity) {
+            // Keep the newest frames: a stale frame is worth less than a fresh one
+            queue.pop_front();
+            --pending_count;
+            ++frames_dropped;
+            DispatcherMetrics::get().dropped.inc();
+        }
+        Request request;
+        request.frame = frame;
+        request.input_size = input_size;
+        request.on_done = std::move(on_done);
+        request.on_error = std::move(on_error);
+        request.arrival = Clock::now();
+        queue.push_back(std::move(request));
+        ++pending_count;
+        ++frames_submitted;
+    }
+    work_ready.notify_one();
+    return true;
+}
+
+void BatchDispatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    space_ready.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+BatchDispatcherStats BatchDispatcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    BatchDispatcherStats stats;
+    stats.frames_submitted = frames_submitted;
+    stats.frames_dropped = frames_dropped;
+    stats.frames_processed = frames_processed;
+    stats.batches = batches;
+    stats.pending = pending_count;
+    return stats;
+}
+
+BatchDispatcher::Clock::time_point BatchDispatcher::oldestArrival() const {
+    Clock::time_point oldest = Clock::time_point::max();
+    for (const auto& entry : pending) {
+        if (!entry.second.empty() && entry.second.front().arrival < oldest) {
+            oldest = entry.second.front().arrival;
+        }
+    }
+    return oldest;
+}
+
+void BatchDispatcher::takeBatch(std::vector<Request>& batch) {
+    // Round-robin over sources, one frame per source per pass, resuming after
+    // the source served last. The first frame taken fixes the batch's input size;
+    // frames of other sizes wait for a later batch.
+    bool progress = true;
+    while (progress && static_cast<int>(batch.size()) < config.max_batch && pending_count > 0) {
+        progress = false;
+        auto it = pending.upper_bound(last_source);
+        for (size_t visited = 0; visited < pending.size() &&
+                                 static_cast<int>(batch.size()) < config.max_batch; ++visited) {
+            if (it == pending.end()) {
+                it = pending.begin();
+            }
+            if (!it->second.empty() &&
+                (batch.empty() || it->second.front().input_size == batch.front().input_size)) {
+                batch.push_back(std::move(it->second.front()));
+                it->second.pop_front();
+                --pending_count;
+                last_source = it->first;
+                progress = true;
+            }
+            ++it;
+        }
+    }
+}
+
+void BatchDispatcher::workerLoop(YOLODetector* detector) {
+    std::vector<Request> batch;
+    std::vector<cv::Mat> frames;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [this] { return stopping || pending_count > 0; });
+            if (pending_count == 0) {
+                return; // stopping and fully drained
+            }
+            // Give a partial batch until max_wait after its oldest frame arrived to fill up
+            Clock::time_point deadline = oldestArrival() + std::chrono::milliseconds(config.max_wait_ms);
+            work_ready.wait_until(lock, deadline, [this] {
+                return stopping || static_cast<int>(pending_count) >= config.max_batch;
+            });
+            takeBatch(batch);
+            if (batch.empty()) {
+                continue; // another worker took the frames
+            }
+        }
+        if (config.max_pending > 0) {
+            space_ready.notify_all();
+        }
+
+        DispatcherMetrics& metrics = DispatcherMetrics::get();
+        const Clock::time_point started = Clock::now();
+        frames.clear();
+        for (const Request& request : batch) {
+            frames.push_back(request.frame);
+            metrics.queue_wait_ms.observe(
+                std::chrono::duration<double, std::milli>(started - request.arrival).count());
+        }
+        metrics.batch_size.observe(static_cast<double>(batch.size()));
+        std::vector<std::vector<Detection>> results;
+        std::exception_ptr error;
+        try {
+            if (batch.front().input_size.area() > 0) {
+                detector->setInputSize(batch.front().input_size);
+            }
+            results = detector->detectBatch(frames);
+        } catch (const std::exception& e) {
+            YOLO_LOG(LogLevel::Error, "Batch inference failed: " << e.what());
+            error = std::current_exception();
+            results.assign(batch.size(), std::vector<Detection>());
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (error && batch[i].on_error) {
+                batch[i].on_error(error);
+            } else if (batch[i].on_done) {
+                batch[i].on_done(std::move(results[i]));
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            frames_processed += batch.size();
+            ++batches;
+        }
+        batch.clear();
+    }
+}
@@ -0,0 +1,212 @@
+#include "capture.h"
+#include "logger.h"
+#include <opencv2/videoio/registry.hpp>
+#include <algorithm>
+#include <sstream>
+#ifdef __linux__
+#include <dirent.h>
+#include <cstring>
+#endif
+
+// CaptureConfig struct implementation
+CaptureConfig::CaptureConfig()
+    : backend(CaptureBackend::Auto), hw_decode(true), decode_threads(0), ring_size(12),
+      open_timeout_ms(10000), read_timeout_ms(5000) {}
+
+CaptureBackend parseCaptureBackend(const std::string& name) {
+    if (name == "ffmpeg") return CaptureBackend::FFmpeg;
+    if (name == "gstreamer") return CaptureBackend::GStreamer;
+    return CaptureBackend::Auto;
+}
+
+bool vaapiAvailable() {
+#ifdef __linux__
+    DIR* dri = opendir("/dev/dri");
+    if (!dri) {
+        return false;
+    }
+    bool found = false;
+    while (dirent* entry = readdir(dri)) {
+        if (std::strncmp(entry->d_name, "renderD", 7) == 0) {
+            found = true;
+            break;
+        }
+    }
+    closedir(dri);
+    return found;
+#else
+    return false;
+#endif
+}
+
+bool isNetworkUrl(const std::string& url) {
+    return url.find("://") != std::string::npos;
+}
+
+bool isCameraIndex(const std::string& url) {
+    return !url.empty() && url.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// FrameRing class implementation
+FrameRing::FrameRing(size_t size) : buffers(std::max<size_t>(size, 1)), next(0), allocations(0) {}
+
+cv::Mat& FrameRing::acquire() {
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        cv::Mat& buffer = buffers[next];
+        next = (next + 1) % buffers.size();
+        if (buffer.empty()) {
+            ++allocations;
+            return buffer;
+        }
+        // Only the ring itself still holds the buffer
+        if (buffer.u && buffer.u->refcount == 1) {
+            return buffer;
+        }
+    }
+    // Every buffer is still in use downstream; give one up to its holder and start over
+    cv::Mat& buffer = buffers[next];
+    next = (next + 1) % buffers.size();
+    buffer.release();
+    ++allocations;
+    return buffer;
+}
+
+namespace {
+
+// decodebin picks a VA-API decoder by rank when gstreamer-vaapi is installed;
+// vaapipostproc then scales on the video engine before the frame is downloaded
+std::string gstreamerPipeline(const std::string& source, const cv::Size& scale, bool hw,
+                              int read_timeout_ms) {
+    std::ostringstream pipeline;
+    const bool file = !isCameraIndex(source) && !isNetworkUrl(source);
+    if (isCameraIndex(source)) {
+        pipeline << "v4l2src device=/dev/video" << source << " ! decodebin";
+    } else if (file) {
+        pipeline << "filesrc location=\"" << source << "\" ! decodebin";
+    } else if (source.compare(0, 7, "rtsp://") == 0) {
+        // rtspsrc, unlike uridecodebin, can fail a connection that stops sending
+        pipeline << "rtspsrc location=\"" << source << "\" latency=0";
+        if (read_timeout_ms > 0) {
+            pipeline << " tcp-timeout=" << static_cast<int64_t>(read_timeout_ms) * 1000;
+        }
+        pipeline << " ! decodebin";
+    } else {
+        pipeline << "uridecodebin uri=\"" << source << "\"";
+    }
+    if (hw) {
+        pipeline << " ! vaapipostproc";
+        if (scale.area() > 0) {
+            pipeline << " width=" << scale.width << " height=" << scale.height;
+        }
+    } else if (scale.area() > 0) {
+        // Scaling the YUV planes first leaves less to convert
+        pipeline << " ! videoscale ! video/x-raw,width=" << scale.width << ",height=" << scale.height;
+    }
+    pipeline << " ! videoconvert ! video/x-raw,format=BGR";
+    // Live sources keep only the newest frame; files must not skip any
+    pipeline << (file ? " ! appsink sync=false" : " ! appsink sync=false drop=true max-buffers=1");
+    return pipeline.str();
+}
+
+} // namespace
+
+// VideoSource class implementation
+VideoSource::VideoSource(const CaptureConfig& cfg)
+    : config(cfg), ring(cfg.ring_size), hw_active(false) {}
+
+bool VideoSource::openGStreamer(const std::string& source, bool hw) {
+    // A source that already is a pipeline is used as given
+    const std::string pipeline = source.find(" ! ") != std::string::npos
+        ? source
+        : gstreamerPipeline(source, config.scale_to, hw, config.read_timeout_ms);
+    YOLO_LOG(LogLevel::Debug, "GStreamer pipeline: " << pipeline);
+    if (!cap.open(pipeline, cv::CAP_GSTREAMER)) {
+        return false;
+    }
+    hw_active = hw;
+    return true;
+}
+
+bool VideoSource::openFFmpeg(const std::string& source, bool hw) {
+    const int api = config.backend == CaptureBackend::FFmpeg && cv::videoio_registry::hasBackend(cv::CAP_FFMPEG)
+        ? cv::CAP_FFMPEG
+        : cv::CAP_ANY;
+    std::vector<int> params;
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    params.push_back(cv::CAP_PROP_HW_ACCELERATION);
+    params.push_back(hw ? cv::VIDEO_ACCELERATION_VAAPI : cv::VIDEO_ACCELERATION_NONE);
+    if (config.decode_threads > 0) {
+        params.push_back(cv::CAP_PROP_N_THREADS);
+        params.push_back(config.decode_threads);
+    }
+    // Without a read timeout a stream that goes silent blocks read() forever
+    if (isNetworkUrl(source) && config.open_timeout_ms > 0) {
+        params.push_back(cv::CAP_PROP_OPEN_TIMEOUT_MSEC);
+        params.push_back(config.open_timeout_ms);
+    }
+    if (isNetworkUrl(source) && config.read_timeout_ms > 0) {
+        params.push_back(cv::CAP_PROP_READ_TIMEOUT_MSEC);
+        params.push_back(config.read_timeout_ms);
+    }
+    if (isCameraIndex(source) ? !cap.open(std::stoi(source), cv::CAP_ANY, params)
+                              : !cap.open(source, api, params)) {
+        return false;
+    }
+    hw_active = cap.get(cv::CAP_PROP_HW_ACCELERATION) != cv::VIDEO_ACCELERATION_NONE;
+#else
+    // No acceleration or thread parameters before OpenCV 4.6
+    if (hw || (isCameraIndex(source) ? !cap.open(std::stoi(source)) : !cap.open(source, api))) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool VideoSource::open(const std::string& source) {
+    cap.release();
+    hw_active = false;
+    const bool hw = config.hw_decode && vaapiAvailable();
+
+    CaptureBackend backend = config.backend;
+    const bool pipeline = source.find(" ! ") != std::string::npos;
+    if (backend == CaptureBackend::Auto && (pipeline || config.scale_to.area() > 0)) {
+        backend = CaptureBackend::GStreamer;
+    }
+    if (backend == CaptureBackend::GStreamer && !cv::videoio_registry::hasBackend(cv::CAP_GSTREAMER)) {
+        YOLO_LOG(LogLevel::Warning, "OpenCV was built without GStreamer, decoding with FFmpeg");
+        backend = CaptureBackend::FFmpeg;
+    }
+    if (backend != CaptureBackend::GStreamer && config.scale_to.area() > 0) {
+        YOLO_LOG(LogLevel::Warning, "Decoder-side scaling needs GStreamer, frames keep their size");
+    }
+
+    // Try the VA-API path first and fall back to software decoding if it fails
+    bool opened;
+    if (backend == CaptureBackend::GStreamer) {
+        opened = (hw && openGStreamer(source, true)) || openGStreamer(source, false);
+    } else {
+        opened = (hw && openFFmpeg(source, true)) || openFFmpeg(source, false);
+    }
+    if (!opened) {
+        return false;
+    }
+    backend_name = cap.getBackendName();
+    YOLO_LOG(LogLevel::Info, "Capture: " << backend_name << (hw_active ? " with VA-API" : "")
+              << " decoding " << source);
+    return true;
+}
+
+bool VideoSource::retrieve(cv::Mat& frame) {
+    // Let go of the caller's previous frame first so its buffer can come back around
+    frame.release();
+    cv::Mat& buffer = ring.acquire();
+    if (!cap.retrieve(buffer) || buffer.empty()) {
+        return false;
+    }
+    frame = buffer;
+    return true;
+}
+
+bool VideoSource::read(cv::Mat& frame) {
+    return cap.grab() && retrieve(frame);
+}
@@ -1,150 +1,391 @@
 #include "inference.h"
+#include "model_source.h"
+#include "input_size.h"
+#include "metrics.h"
 #include <fstream>
 #include <iostream>
 #include <algorithm>
-#include <read_json.h>
+#include <sstream>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include "pipeline.h"
+#include "yolo_decode.h"
+#include "sinks.h"
+#include "logger.h"
+#include <chrono>
+#include "zones.h"
 
 // Detection struct implementation
 Detection::Detection(int id, float conf, cv::Rect box, const std::string& name)
-    : class_id(id), confidence(conf), bbox(box), class_name(name) {}
+    : class_id(id), confidence(conf), bbox(box), class_name(name), track_id(-1) {}
 
 // YOLOConfig struct implementation
 YOLOConfig::YOLOConfig(const std::string& model, const std::string& config)
     : model_path(model), config_path(config), confidence_threshold(0.5f), 
-      nms_threshold(0.4f), input_size(cv::Size(640, 640)), 
-      mean(cv::Scalar(0, 0, 0)), scale_factor(1.0/255.0), swap_rb(true) {}
+      nms_threshold(0.4f), nms_method(NmsMethod::Hard), nms_per_class(true),
+      nms_top_k(1000), soft_nms_sigma(0.5f), input_size(cv::Size(640, 640)), 
+      mean(cv::Scalar(0, 0, 0)), scale_factor(1.0/255.0), swap_rb(true),
+      letterbox(false), letterbox_pad(114.f), backend(cv::dnn::DNN_BACKEND_OPENCV),
+      target(cv::dnn::DNN_TARGET_CPU), num_threads(0), warmup(true) {}
+
+// StageTimings struct implementation
+StageTimings::StageTimings() : preprocess_ms(0), forward_ms(0), parse_ms(0), nms_ms(0) {}
+
+// StartupTimings struct implementation
+StartupTimings::StartupTimings() : map_ms(0), parse_ms(0), warmup_ms(0), total_ms(0) {}
+
+namespace {
+
+double ticksToMs(int64_t ticks) {
+    return ticks * 1000.0 / cv::getTickFrequency();
+}
+
+// Shared by every detector; registered on first use, then updated lock-free
+struct DetectorMetrics {
+    MetricHistogram& preprocess_ms;
+    MetricHistogram& forward_ms;
+    MetricHistogram& parse_ms;
+    MetricHistogram& nms_ms;
+    MetricCounter& images;
+
+    DetectorMetrics()
+        : preprocess_ms(stage("preprocess")), forward_ms(stage("forward")),
+          parse_ms(stage("parse")), nms_ms(stage("nms")),
+          images(MetricsRegistry::instance().counter("yolo_detector_images_total",
+                                                     "Images run through the detector")) {}
+
+    static MetricHistogram& stage(const std::string& name) {
+        return MetricsRegistry::instance().histogram(
+            "yolo_stage_ms", "Detector stage wall time per call in milliseconds", {{"stage", name}});
+    }
+    static DetectorMetrics& get() {
+        static DetectorMetrics metrics;
+        return metrics;
+    }
+};
+
+} // namespace
 
 // YOLODetector class implementation
-YOLODetector::YOLODetector(const YOLOConfig& cfg) : config(cfg) {
-    // Load the network
-    if (config.config_path.empty()) {
-        net = cv::dnn::readNetFromDarknet(config.model_path);
-    } else {
-        net = cv::dnn::readNetFromDarknet(config.config_path, config.model_path);
+YOLODetector::YOLODetector(const YOLOConfig& cfg) : YOLODetector(cfg, nullptr) {}
+
+YOLODetector::YOLODetector(const YOLOConfig& cfg, std::shared_ptr<const ModelSource> source)
+    : config(cfg), model(std::move(source)), onnx_model(YOLOUtils::isOnnxModel(cfg.model_path)) {
+    const int64_t start = cv::getTickCount();
+    if (!model) {
+        model = ModelSource::open(config.model_path, config.config_path);
     }
+    const int64_t mapped = cv::getTickCount();
+    
+    // Load the network from the mapped files
+    net = model->createNet();
     
     // Get output layer names
     output_layer_names = net.getUnconnectedOutLayersNames();
     
-    // Set backend and target
-    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    // Set backend, target and threading
+    configureBackend();
+    const int64_t parsed = cv::getTickCount();
+    
+    preprocessor.configure(config.mean, config.scale_factor, config.swap_rb, config.letterbox_pad);
+    for (const std::string& name : config.class_names) {
+        class_counters.push_back(&MetricsRegistry::instance().counter(
+            "yolo_detections_total", "Objects detected per class", {{"class", name}}));
+    }
+    suppressor.configure(config.nms_method, config.nms_per_class, config.nms_top_k,
+                         config.soft_nms_sigma);
+    
+    // Reserve candidate buffers once; clear() keeps the capacity between frames
+    class_ids.reserve(1024);
+    confidences.reserve(1024);
+    boxes.reserve(1024);
+    indices.reserve(1024);
+    
+    if (config.warmup) {
+        warmup();
+    }
+    const int64_t warmed = cv::getTickCount();
+    startup.map_ms = ticksToMs(mapped - start);
+    startup.parse_ms = ticksToMs(parsed - mapped);
+    startup.warmup_ms = ticksToMs(warmed - parsed);
+    startup.total_ms = ticksToMs(warmed - start);
+    YOLO_LOG(LogLevel::Info, "Detector ready in " << startup.total_ms << " ms (map " << startup.map_ms
+              << ", parse " << startup.parse_ms << ", warmup " << startup.warmup_ms << ")");
+}
+
+std::unique_ptr<YOLODetector> YOLODetector::clone() const {
+    return std::unique_ptr<YOLODetector>(new YOLODetector(config, model));
+}
+
+void YOLODetector::warmup() {
+    // Layer fusion, weight repacking and buffer allocation happen on the first
+    // forward; pay for them here with a blank input of the real size
+    const int shape[] = {1, 3, config.input_size.height, config.input_size.width};
+    blob.create(4, shape, CV_32F);
+    blob.setTo(cv::Scalar::all(0));
+    net.setInput(blob);
+    net.forward(outputs, output_layer_names);
+}
+
+bool YOLODetector::setInputSize(const cv::Size& size) {
+    const cv::Size aligned = alignInputSize(size);
+    if (aligned == config.input_size) {
+        return true;
+    }
+    const cv::Size previous = config.input_size;
+    size_nets[std::make_pair(previous.width, previous.height)] = net;
+    config.input_size = aligned;
+    auto cached = size_nets.find(std::make_pair(aligned.width, aligned.height));
+    if (cached != size_nets.end()) {
+        net = cached->second;
+        return true;
+    }
+    try {
+        net = model->createNet();
+        net.setPreferableBackend(config.backend);
+        net.setPreferableTarget(config.target);
+        // Also rejects fixed-shape ONNX exports right away instead of on a live frame
+        warmup();
+    } catch (const cv::Exception& e) {
+        YOLO_LOG(LogLevel::Error, "Input size " << aligned.width << "x" << aligned.height
+                 << " is not supported by the model: " << e.what());
+        config.input_size = previous;
+        net = size_nets[std::make_pair(previous.width, previous.height)];
+        return false;
+    }
+    YOLO_LOG(LogLevel::Debug, "Input size " << aligned.width << "x" << aligned.height << " ready");
+    return true;
+}
+
+bool YOLODetector::prepareInputSize(const cv::Size& size) {
+    const cv::Size previous = config.input_size;
+    const bool supported = setInputSize(size);
+    setInputSize(previous);
+    return supported;
+}
+
+void YOLODetector::configureBackend() {
+    // Pin before resizing the thread pool so the pool's threads inherit the mask
+    if (!config.cpu_affinity.empty() && !YOLOUtils::setCpuAffinity(config.cpu_affinity)) {
+        YOLO_LOG(LogLevel::Warning, "Could not set CPU affinity, continuing unpinned.");
+    }
+    if (config.num_threads > 0) {
+        cv::setNumThreads(config.num_threads);
+    }
+    
+    // getAvailableBackends() lists concrete backends only; "default" is OpenCV's own
+    if (config.backend == cv::dnn::DNN_BACKEND_DEFAULT) {
+        config.backend = cv::dnn::DNN_BACKEND_OPENCV;
+    }
+
+    // Without native FP16 arithmetic the FP16 CPU path only adds conversions
+    const bool fp16_cpu = YOLOUtils::cpuSupportsFp16();
+    if (config.target == YOLOUtils::AUTO_TARGET) {
+        config.target = cv::dnn::DNN_TARGET_CPU;
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+        if (fp16_cpu && config.backend == cv::dnn::DNN_BACKEND_OPENCV) {
+            config.target = cv::dnn::DNN_TARGET_CPU_FP16;
+        }
+#endif
+    }
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+    if (config.target == cv::dnn::DNN_TARGET_CPU_FP16 && !fp16_cpu) {
+        YOLO_LOG(LogLevel::Warning, "This CPU has no native FP16 arithmetic, using target cpu.");
+        config.target = cv::dnn::DNN_TARGET_CPU;
+    }
+#endif
+    
+    // Probe what this OpenCV build supports and fall back instead of failing at forward()
+    bool available = false;
+    for (const auto& pair : cv::dnn::getAvailableBackends()) {
+        if (pair.first == config.backend && pair.second == config.target) {
+            available = true;
+            break;
+        }
+    }
+    if (!available) {
+        YOLO_LOG(LogLevel::Warning, "Backend " << YOLOUtils::backendName(config.backend) << " / target "
+                 << YOLOUtils::targetName(config.target)
+                 << " is not available, falling back to opencv / cpu.");
+        config.backend = cv::dnn::DNN_BACKEND_OPENCV;
+        config.target = cv::dnn::DNN_TARGET_CPU;
+    }
+    net.setPreferableBackend(config.backend);
+    net.setPreferableTarget(config.target);
+    YOLO_LOG(LogLevel::Info, "Loaded " << (onnx_model ? "ONNX" : "Darknet") << " model " << config.model_path
+              << " (" << model->sizeBytes() / (1024 * 1024) << " MiB mapped)");
+    YOLO_LOG(LogLevel::Info, "Using backend " << YOLOUtils::backendName(config.backend)
+              << ", target " << YOLOUtils::targetName(config.target)
+              << ", " << cv::getNumThreads() << " threads");
 }
 
 std::vector<Detection> YOLODetector::detect(const cv::Mat& image) {
-    // Clear previous results
-    class_ids.clear();
-    confidences.clear();
-    boxes.clear();
+    if (image.empty()) {
+        return std::vector<Detection>();
+    }
     
-    // Create blob from image
-    cv::dnn::blobFromImage(image, blob, config.scale_factor, 
-                          config.input_size, config.mean, 
-                          config.swap_rb, false);
+    const int64_t start = cv::getTickCount();
+    timings = StageTimings();
+    
+    // Fill the persistent input blob from the image
+    prepareBlob(std::vector<cv::Mat>(1, image));
+    const int64_t preprocessed = cv::getTickCount();
     
     // Set input to the network
     net.setInput(blob);
     
     // Run forward pass
     net.forward(outputs, output_layer_names);
+    const int64_t forwarded = cv::getTickCount();
+    
+    timings.preprocess_ms = ticksToMs(preprocessed - start);
+    timings.forward_ms = ticksToMs(forwarded - preprocessed);
+    std::vector<Detection> detections = postprocess(transforms[0], 0, 1);
+    recordTimings(1);
+    return detections;
+}
+
+std::vector<Detection> YOLODetector::detect(const cv::Mat& image, const cv::Rect& roi) {
+    cv::Rect region = roi & cv::Rect(0, 0, image.cols, image.rows);
+    if (region.empty()) {
+        return std::vector<Detection>();
+    }
+    // A Mat ROI is only a header onto the frame's pixels
+    std::vector<Detection> detections = detect(image(region));
+    for (auto& detection : detections) {
+        detection.bbox += region.tl();
+    }
+    return detections;
+}
+
+std::vector<std::vector<Detection>> YOLODetector::detectBatch(const std::vector<cv::Mat>& images) {
+    std::vector<std::vector<Detection>> results;
+    if (images.empty()) {
+        return results;
+    }
+    
+    const int64_t start = cv::getTickCount();
+    timings = StageTimings();
+    
+    // One N x 3 x H x W blob and a single forward pass for the whole batch
+    prepareBlob(images);
+    const int64_t preprocessed = cv::getTickCount();
+    net.setInput(blob);
+    net.forward(outputs, output_layer_names);
+    const int64_t forwarded = cv::getTickCount();
+    timings.preprocess_ms = ticksToMs(preprocessed - start);
+    timings.forward_ms = ticksToMs(forwarded - preprocessed);
+    
+    // Split the outputs back per image, each with its own scale factors
+    const int batch_size = static_cast<int>(images.size());
+    results.reserve(images.size());
+    for (int b = 0; b < batch_size; ++b) {
+        results.push_back(postprocess(transforms[b], b, batch_size));
+    }
+    recordTimings(images.size());
+    return results;
+}
+
+void YOLODetector::recordTimings(size_t images) const {
+    DetectorMetrics& metrics = DetectorMetrics::get();
+    metrics.preprocess_ms.observe(timings.preprocess_ms);
+    metrics.forward_ms.observe(timings.forward_ms);
+    metrics.parse_ms.observe(timings.parse_ms);
+    metrics.nms_ms.observe(timings.nms_ms);
+    metrics.images.inc(images);
+}
+
+void YOLODetector::prepareBlob(const std::vector<cv::Mat>& images) {
+    // create() is a no-op while the batch size and input size stay the same
+    const int shape[] = {static_cast<int>(images.size()), 3,
+                         config.input_size.height, config.input_size.width};
+    blob.create(4, shape, CV_32F);
+    
+    transforms.resize(images.size());
+    for (size_t b = 0; b < images.size(); ++b) {
+        transforms[b] = LetterboxTransform(images[b].size(), config.input_size, config.letterbox);
+        preprocessor.pack(images[b], transforms[b], blob.ptr<float>(static_cast<int>(b)));
+    }
+}
+
+std::vector<Detection> YOLODetector::postprocess(const LetterboxTransform& transform, int batch_index, int batch_size) {
+    // Clear previous results
+    class_ids.clear();
+    confidences.clear();
+    boxes.clear();
     
     // Parse outputs
-    parseOutputs(outputs, image.size());
+    const int64_t start = cv::getTickCount();
+    parseOutputs(outputs, transform, batch_index, batch_size);
+    const int64_t parsed = cv::getTickCount();
     
     // Apply Non-Maximum Suppression
-    cv::dnn::NMSBoxes(boxes, confidences, config.confidence_threshold, 
-                     config.nms_threshold, indices);
+    suppressor.run(boxes, confidences, class_ids, config.confidence_threshold,
+                   config.nms_threshold, indices);
+    
+    // Batched calls add up the per-image post-processing
+    timings.parse_ms += ticksToMs(parsed - start);
+    timings.nms_ms += ticksToMs(cv::getTickCount() - parsed);
     
     // Build final detection results
     std::vector<Detection> detections;
+    detections.reserve(indices.size());
     for (int idx : indices) {
-        std::string class_name = (class_ids[idx] < config.class_names.size()) ? 
+        std::string class_name = (class_ids[idx] < static_cast<int>(config.class_names.size())) ? 
                                config.class_names[class_ids[idx]] : 
                                "Unknown";
         detections.emplace_back(class_ids[idx], confidences[idx], 
                               boxes[idx], class_name);
+        if (class_ids[idx] < static_cast<int>(class_counters.size())) {
+            class_counters[class_ids[idx]]->inc();
+        }
     }
     
     return detections;
 }
 
-void YOLODetector::parseOutputs(const std::vector<cv::Mat>& outputs, cv::Size image_size) {
-    float x_factor = static_cast<float>(image_size.width) / config.input_size.width;
-    float y_factor = static_cast<float>(image_size.height) / config.input_size.height;
-    
+void YOLODetector::parseOutputs(const std::vector<cv::Mat>& outputs, const LetterboxTransform& transform,
+                                int batch_index, int batch_size) {
+    const LetterboxTransform mapping = onnx_model ? inputPixelTransform(transform) : transform;
     for (const auto& output : outputs) {
-        // Handle different output dimensions (2D vs 3D)
-        cv::Mat flat_output;
+        // Handle different output dimensions: the region layer emits a 2D
+        // rows x cols matrix for a single image and N x rows x cols for a batch
+        int rows = 0;
+        int cols = 0;
         if (output.dims == 3) {
-            // 3D output: reshape to 2D
-            flat_output = output.reshape(1, output.size[1]);
+            rows = output.size[1];
+            cols = output.size[2];
         } else if (output.dims == 2) {
-            // Already 2D
-            flat_output = output;
+            // Already 2D, image rows are stacked when batched
+            rows = output.rows / batch_size;
+            cols = output.cols;
         } else {
-            std::cerr << "Unsupported output dimensions: " << output.dims << std::endl;
+            YOLO_LOG(LogLevel::Error, "Unsupported output dimensions: " << output.dims);
             continue;
         }
+        const float* image_rows = output.ptr<float>() + static_cast<size_t>(batch_index) * rows * cols;
         
-        const int rows = flat_output.rows;
-        const int cols = flat_output.cols;
+        // Anchor-free ONNX exports (YOLOv8 style) are channels x anchors: far fewer
+        // channels than anchors and no objectness row
+        if (onnx_model && output.dims == 3 && rows < cols) {
+            if (rows < 5) {
+                YOLO_LOG(LogLevel::Error, "Output has insufficient channels: " << rows);
+                continue;
+            }
+            decodeAnchorFreeColumns(image_rows, rows, cols, config.confidence_threshold, mapping,
+                                    boxes, confidences, class_ids, best_scores, best_classes);
+            continue;
+        }
         
         // Verify minimum columns (x, y, w, h, confidence + at least 1 class)
         if (cols < 6) {
-            std::cerr << "Output has insufficient columns: " << cols << std::endl;
+            YOLO_LOG(LogLevel::Error, "Output has insufficient columns: " << cols);
             continue;
         }
         
-        for (int i = 0; i < rows; ++i) {
-            const float* data = flat_output.ptr<float>(i);
-            
-            // Extract coordinates and confidence
-            float cx = data[0];
-            float cy = data[1];
-            float w = data[2];
-            float h = data[3];
-            float confidence = data[4];
-            
-            if (confidence >= config.confidence_threshold) {
-                // Find best class
-                float max_class_score = 0;
-                int best_class_id = 0;
-                
-                for (int j = 5; j < cols; ++j) {
-                    if (data[j] > max_class_score) {
-                        max_class_score = data[j];
-                        best_class_id = j - 5;
-                    }
-                }
-                
-                if (max_class_score > config.confidence_threshold) {
-                    // Convert normalized coordinates to pixel coordinates
-                    // cx, cy, w, h are in range [0, 1] relative to input size
-                    float pixel_cx = cx * image_size.width;
-                    float pixel_cy = cy * image_size.height;
-                    float pixel_w = w * image_size.width;
-                    float pixel_h = h * image_size.height;
-                    
-                    // Convert center coordinates to top-left corner
-                    int left = static_cast<int>(pixel_cx - 0.5 * pixel_w);
-                    int top = static_cast<int>(pixel_cy - 0.5 * pixel_h);
-                    int width = static_cast<int>(pixel_w);
-                    int height = static_cast<int>(pixel_h);
-                    
-                    // Ensure bounding box is within image bounds
-                    left = std::max(0, left);
-                    top = std::max(0, top);
-                    width = std::min(width, image_size.width - left);
-                    height = std::min(height, image_size.height - top);
-                    
-                    if (width > 0 && height > 0) {
-                        boxes.emplace_back(left, top, width, height);
-                        confidences.push_back(confidence);
-                        class_ids.push_back(best_class_id);
-                    }
-                }
-            }
-        }
+        decodeYoloRows(image_rows, rows, cols, config.confidence_threshold, mapping,
+                       boxes, confidences, class_ids);
     }
 }
 
@@ -164,12 +405,12 @@ namespace YOLOUtils {
         for (const auto& detection : detections) {
             // Draw bounding box
             cv::rectangle(image, detection.bbox, cv::Scalar(0, 255, 0), 2);
-            printf("Detected %s with confidence %.2f in location (%d, %d, %d, %d)\n", 
-                  detection.class_name.c_str(), detection.confidence, detection.bbox.x, 
-                  detection.bbox.y, detection.bbox.width, detection.bbox.height);
             // Draw label
             std::string label = detection.class_name + ": " + 
                               std::to_string(detection.confidence);
+            if (detection.track_id >= 0) {
+                label = "#" + std::to_string(detection.track_id) + " " + label;
+            }
             int baseline;
             cv::Size text_size = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
                                                0.5, 1, &baseline);
@@ -189,10 +430,147 @@ namespace YOLOUtils {
         cv::putText(image, fps_text, cv::Point(10, 30), 
                    cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 0), 2);
     }
+    
+    int parseBackend(const std::string& name) {
+        if (name == "default") return cv::dnn::DNN_BACKEND_DEFAULT;
+        if (name == "openvino" || name == "ie") return cv::dnn::DNN_BACKEND_INFERENCE_ENGINE;
+        if (name == "cuda") return cv::dnn::DNN_BACKEND_CUDA;
+        if (name == "vulkan") return cv::dnn::DNN_BACKEND_VKCOM;
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+        if (name == "timvx") return cv::dnn::DNN_BACKEND_TIMVX;
+#endif
+        if (name != "opencv") {
+            std::cerr << "Unknown backend '" << name << "', using opencv." << std::endl;
+        }
+        return cv::dnn::DNN_BACKEND_OPENCV;
+    }
+    
+    bool cpuSupportsFp16() {
+#ifdef CV_CPU_NEON_FP16
+        return cv::checkHardwareSupport(CV_CPU_NEON_FP16);
+#else
+        // OpenCV only has FP16 CPU kernels for ARMv8.2+; elsewhere cpu_fp16 runs at FP32 speed
+        return false;
+#endif
+    }
+    
+    bool isOnnxModel(const std::string& path) {
+        std::string lower = path;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        return lower.size() > 5 && lower.compare(lower.size() - 5, 5, ".onnx") == 0;
+    }
+    
+    int parseTarget(const std::string& name) {
+        if (name == "auto") return AUTO_TARGET;
+        if (name == "opencl") return cv::dnn::DNN_TARGET_OPENCL;
+        if (name == "opencl_fp16") return cv::dnn::DNN_TARGET_OPENCL_FP16;
+        if (name == "myriad") return cv::dnn::DNN_TARGET_MYRIAD;
+        if (name == "cuda") return cv::dnn::DNN_TARGET_CUDA;
+        if (name == "cuda_fp16") return cv::dnn::DNN_TARGET_CUDA_FP16;
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+        if (name == "npu") return cv::dnn::DNN_TARGET_NPU;
+#endif
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+        if (name == "cpu_fp16") return cv::dnn::DNN_TARGET_CPU_FP16;
+#endif
+        if (name != "cpu") {
+            std::cerr << "Unknown or unsupported target '" << name << "', using cpu." << std::endl;
+        }
+        return cv::dnn::DNN_TARGET_CPU;
+    }
+    
+    std::string backendName(int backend) {
+        switch (backend) {
+            case cv::dnn::DNN_BACKEND_DEFAULT: return "default";
+            case cv::dnn::DNN_BACKEND_OPENCV: return "opencv";
+            case cv::dnn::DNN_BACKEND_INFERENCE_ENGINE: return "openvino";
+            case cv::dnn::DNN_BACKEND_CUDA: return "cuda";
+            case cv::dnn::DNN_BACKEND_VKCOM: return "vulkan";
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+            case cv::dnn::DNN_BACKEND_TIMVX: return "timvx";
+#endif
+            default: return "backend#" + std::to_string(backend);
+        }
+    }
+    
+    std::string targetName(int target) {
+        switch (target) {
+            case AUTO_TARGET: return "auto";
+            case cv::dnn::DNN_TARGET_CPU: return "cpu";
+            case cv::dnn::DNN_TARGET_OPENCL: return "opencl";
+            case cv::dnn::DNN_TARGET_OPENCL_FP16: return "opencl_fp16";
+            case cv::dnn::DNN_TARGET_MYRIAD: return "myriad";
+            case cv::dnn::DNN_TARGET_CUDA: return "cuda";
+            case cv::dnn::DNN_TARGET_CUDA_FP16: return "cuda_fp16";
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+            case cv::dnn::DNN_TARGET_NPU: return "npu";
+#endif
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+            case cv::dnn::DNN_TARGET_CPU_FP16: return "cpu_fp16";
+#endif
+            default: return "target#" + std::to_string(target);
+        }
+    }
+    
+    std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (item.empty()) continue;
+            size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(item.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+    
+    bool setCpuAffinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &mask);
+            }
+        }
+        return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+}
+
+namespace {
+
+int64_t wallClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
+// Annotates the frame only when some sink will look at it
+void annotateFrame(cv::Mat& frame, const std::vector<Detection>& detections,
+                   const ZoneEngine& zones, bool intrusion) {
+    zones.draw(frame);
+    YOLOUtils::drawDetections(frame, detections);
+    if (intrusion) {
+        cv::putText(frame, "Intrusion Detected!", cv::Point(10, 30), 
+                    cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 255), 2);
+    }
+}
+
+} // namespace
+
+// OutputConfig struct implementation
+OutputConfig::OutputConfig() : display(true) {}
+
 // Function to run inference on an image
-void run_image_inference(const std::string& image_path, YOLODetector& detector)
+void run_image_inference(const std::string& image_path, YOLODetector& detector,
+                         const OutputConfig& output_config)
 {
     cv::Mat img = cv::imread(image_path);
     if (img.empty()) {
@@ -203,143 +581,139 @@ void run_image_inference(const std::string& image_path, YOLODetector& detector)
     // Perform detection
     std::vector<Detection> detections = detector.detect(img);
     
-    // Draw detections
-    YOLOUtils::drawDetections(img, detections);
+    SinkSet sinks;
+    OutputConfig image_output = output_config;
+    image_output.display = false; // shown below with waitKey(0)
+    createSinks(image_output, "Inference Result", 1.0, sinks);
+    
+    FrameResult result;
+    result.stream_id = image_path;
+    result.timestamp_ms = wallClockMs();
+    result.frame_size = img.size();
+    result.detections = &detections;
+    if (sinks.needsFrame() || output_config.display) {
+        // Draw detections
+        YOLOUtils::drawDetections(img, detections);
+        result.frame = img;
+    }
+    sinks.write(result);
+    sinks.flush();
     
     // Show result
-    cv::imshow("Inference Result", img);
-    cv::waitKey(0);
+    if (output_config.display) {
+        cv::imshow("Inference Result", img);
+        cv::waitKey(0);
+    }
 }
 
-void run_camera_inference(int camera_index, YOLODetector& detector, int num_skipped_frames) {
-    cv::VideoCapture cap(camera_index);
-    if (!cap.isOpened()) {
+void run_camera_inference(int camera_index, YOLODetector& detector,
+                          const PipelineConfig& pipeline_config, const OutputConfig& output_config) {
+    const std::string stream_id = "camera" + std::to_string(camera_index);
+    StreamIngestor cap(std::to_string(camera_index), pipeline_config.capture, pipeline_config.ingest, stream_id);
+    if (!cap.start()) {
         std::cerr << "Could not open camera: " << camera_index << std::endl;
         return;
     }
-    cv::Mat frame;
-    int frame_count = 0;
-    while (true) {
-        if (num_skipped_frames > 0 && ++frame_count % num_skipped_frames == 0) {
-            continue; // Skip frames for performance
+    SinkSet sinks;
+    createSinks(output_config, "Realtime Inference", cap.fps(), sinks);
+    const bool annotate = sinks.needsFrame();
+    
+    InferencePipeline pipeline(cap, detector, pipeline_config);
+    pipeline.run([&](FramePacket& packet) {
+        FrameResult result;
+        result.stream_id = stream_id;
+        result.frame_index = packet.index;
+        result.timestamp_ms = wallClockMs();
+        result.frame_size = packet.frame.size();
+        result.detections = &packet.detections;
+        if (annotate) {
+            YOLOUtils::drawDetections(packet.frame, packet.detections);
+            result.frame = packet.frame;
         }
-        cap >> frame;
-        if (frame.empty()) break;
-        // Replace with your actual inference function
-        std::vector<Detection> detections = detector.detect(frame);
-        YOLOUtils::drawDetections(frame, detections);
-        cv::imshow("Realtime Inference", frame);
-        if (cv::waitKey(1) == 27) break; // ESC to exit
-    }
-    cap.release();
-    cv::destroyAllWindows();
+        return sinks.write(result);
+    });
+    sinks.flush();
+    printPipelineStats(pipeline.getStats());
+    cap.stop();
 }
 void run_rtsp_inference(const std::string& rtsp_url, YOLODetector& detector, 
-                        int num_skipped_frames, bool intrusion_feature, 
-                        const std::string& boxes_json_path) {
-    cv::VideoCapture cap(rtsp_url);
-    if (!cap.isOpened()) {
+                        bool intrusion_feature, 
+                        const std::string& zones_json_path,
+                        const PipelineConfig& pipeline_config, const OutputConfig& output_config) {
+    StreamIngestor cap(rtsp_url, pipeline_config.capture, pipeline_config.ingest, rtsp_url);
+    if (!cap.start()) {
         std::cerr << "Could not open RTSP stream: " << rtsp_url << std::endl;
         return;
     }
-    cv::Mat frame;
-    int frame_count = 0;
-    std::vector<Box> intrusion_areas;
-    std::cout << "Intrusion feature enabled: " << (intrusion_feature ? "Yes" : "No") << std::endl;
+    ZoneEngine zones;
+    YOLO_LOG(LogLevel::Info, "Intrusion feature enabled: " << (intrusion_feature ? "Yes" : "No"));
     if (intrusion_feature) {
-        intrusion_areas = read_json(boxes_json_path);
-        std::cout << "Checking for intrusions..." << std::endl;
-        std::cout << "Read " << intrusion_areas.size() << " boxes from JSON." << std::endl;
-        if (intrusion_areas.empty()) {
-            std::cerr << "No boxes found in JSON file: " << boxes_json_path << std::endl;}
-        else{
-            std::cout << "Box xywh: " << intrusion_areas[0].x1 << ", " << intrusion_areas[0].y1 
-                        << ", " << intrusion_areas[0].x2 << ", " << intrusion_areas[0].y2 << std::endl;
+        if (!zones.load(zones_json_path, detector.getConfig().class_names)) {
+            YOLO_LOG(LogLevel::Warning, "Could not load zones from " << zones_json_path
+                     << ", waiting for the file to change");
+        } else if (zones.empty()) {
+            YOLO_LOG(LogLevel::Warning, "No zones found in JSON file: " << zones_json_path);
+        } else {
+            YOLO_LOG(LogLevel::Info, "Read " << zones.zones().size() << " zones from JSON.");
         }
     }
-    while (true) {
-        std::cout << "Processing frame: " << frame_count << std::endl;
-        if (num_skipped_frames > 0 && ++frame_count % num_skipped_frames == 0) {
-            continue; // Skip frames for performance
-        }
-        cap >> frame;
-        if (frame.empty()) {
-            std::cerr << "Empty frame received from RTSP stream." << std::endl;
-            break;
-        }
-
-        // Draw intrusion boxes
-        if (intrusion_feature && !intrusion_areas.empty()) {
-            std::cout << "Drawing intrusion areas..." << std::endl;
-            for (const auto& intrusion_area : intrusion_areas) {
-                std::cout << "Drawing intrusion area: " 
-                        << intrusion_area.x1 << ", " << intrusion_area.y1 
-                        << ", " << intrusion_area.x2 << ", " << intrusion_area.y2 << std::endl;
-                cv::rectangle(frame, cv::Point(intrusion_area.x1, intrusion_area.y1), 
-                            cv::Point(intrusion_area.x2, intrusion_area.y2), 
-                            cv::Scalar(255, 0, 0), 2);
-            };
+    SinkSet sinks;
+    createSinks(output_config, "RTSP Inference", cap.fps(), sinks);
+    const bool annotate = sinks.needsFrame();
+    
+    PipelineConfig config = pipeline_config;
+    if (config.tiling.enabled && config.tiling.zones_only) {
+        // Spend the tiles on the watched zones only; the full-frame pass covers the rest
+        for (const Zone& zone : zones.zones()) {
+            config.tiling.regions.push_back(zone.bounds);
         }
-        // Replace with your actual inference function
-        std::vector<Detection> detections = detector.detect(frame);
-        std::cout << "Detected " << detections.size() << " objects in frame." << std::endl;
-        YOLOUtils::drawDetections(frame, detections);
-        if (isIntrusion(detections, intrusion_areas, frame.size(), detector.getConfidenceThreshold())) {
-            cv::putText(frame, "Intrusion Detected!", cv::Point(10, 30), 
-                        cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 255), 2);
+        if (config.tiling.regions.empty()) {
+            YOLO_LOG(LogLevel::Warning, "No zones to tile, tiling the whole frame");
         }
-        cv::imshow("RTSP Inference", frame);
-        if (cv::waitKey(1) == 27) break; // ESC to exit
     }
-    cap.release();
-    cv::destroyAllWindows();
-}
-
-std::vector<Box> read_json(const std::string& filename) {
-    std::vector<Box> boxes;
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Could not open the file: " << filename << std::endl
-                    << "Please check the file path and try again." << std::endl;
-         // Return empty vector if file cannot be opened
-        return boxes;
-    }
-    else {
-        nlohmann::json json_data;
-        file >> json_data;
-        for (const auto& item : json_data) {
-            std::cout << "Processing item: " << item.dump() << std::endl;
-            if (item.contains("x1") && item.contains("x2") && 
-                item.contains("y1") && item.contains("y2")) {
-                boxes.emplace_back(item["x1"].get<int>(), item["y1"].get<int>(), 
-                                   item["x2"].get<int>(), item["y2"].get<int>());
-            } else {
-                std::cerr << "Invalid box format in JSON file." << std::endl;
+    InferencePipeline pipeline(cap, detector, config);
+    const float threshold = detector.getConfidenceThreshold();
+    std::vector<ZoneEvent> events;
+    uint64_t unique_intruders = 0;
+    pipeline.run([&](FramePacket& packet) {
+        FrameResult result;
+        result.stream_id = rtsp_url;
+        result.frame_index = packet.index;
+        result.timestamp_ms = wallClockMs();
+        result.frame_size = packet.frame.size();
+        result.detections = &packet.detections;
+        if (intrusion_feature) {
+            // Zones edited on disk are picked up without a restart (tiling keeps its regions)
+            zones.reloadIfChanged(result.timestamp_ms);
+            events.clear();
+            result.intrusion = zones.update(packet.detections, threshold, result.timestamp_ms, events);
+            result.events = &events;
+            // Alert once per tracked object and zone instead of on every frame it stays inside
+            for (const ZoneEvent& event : events) {
+                if (event.type == ZoneEventType::Enter) {
+                    ++unique_intruders;
+                    YOLO_LOG(LogLevel::Warning, "Intrusion: " << event.class_name << " #" << event.track_id
+                              << " entered zone " << event.zone_id);
+                } else if (event.type == ZoneEventType::Dwell) {
+                    YOLO_LOG(LogLevel::Warning, "Intrusion: " << event.class_name << " #" << event.track_id
+                              << " in zone " << event.zone_id << " for " << event.dwell_ms << " ms");
+                } else {
+                    YOLO_LOG(LogLevel::Info, event.class_name << " #" << event.track_id
+                              << " left zone " << event.zone_id << " after " << event.dwell_ms << " ms");
+                }
             }
         }
+        // Zones are drawn after inference so they never leak into the network input
+        if (annotate) {
+            annotateFrame(packet.frame, packet.detections, zones, result.intrusion);
+            result.frame = packet.frame;
+        }
+        return sinks.write(result);
+    });
+    sinks.flush();
+    printPipelineStats(pipeline.getStats());
+    if (intrusion_feature) {
+        YOLO_LOG(LogLevel::Info, "Zone entries: " << unique_intruders);
     }
-    return boxes;
-
+    cap.stop();
 }
-
-bool isIntrusion(const std::vector<Detection>& detections, const std::vector<Box>& boxes, 
-                     const cv::Size& image_size, float threshold) {
-        for (const auto& detection : detections) {
-            if (detection.confidence >= threshold) {
-                // Check if the bounding box is within the boxes defined in the JSON
-                for (const auto&detection : detections) {
-                    for (const auto& box : boxes) {
-                        // Check if the detection bbox intersects with any box
-                        if (detection.bbox.x < box.x2 && detection.bbox.x + detection.bbox.width > box.x1 &&
-                            detection.bbox.y < box.y2 && detection.bbox.y + detection.bbox.height > box.y1) {
-                            std::cout << "Intrusion detected in area defined by box: "
-                                      << "x1=" << box.x1 << ", y1=" << box.y1 
-                                      << ", x2=" << box.x2 << ", y2=" << box.y2 << std::endl;
-                            return true; // Intrusion detected
-                        }
-                    }
-                }
-            }
-        }
-        return false; // No intrusion detected
-    }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "input_size.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+
+// InputSizeConfig struct implementation
+InputSizeConfig::InputSizeConfig()
+    : auto_select(false), small_size(320, 320), large_size(640, 640), min_object_px(24),
+      hold_frames(30), probe_interval(150), latency_budget_ms(0) {}
+
+cv::Size alignInputSize(const cv::Size& size) {
+    auto align = [](int side) { return std::max(32, (side + 16) / 32 * 32); };
+    return cv::Size(align(size.width), align(size.height));
+}
+
+bool parseInputSize(const std::string& text, cv::Size& size) {
+    int width = 0, height = 0;
+    int fields = std::sscanf(text.c_str(), "%dx%d", &width, &height);
+    if (fields == 1) {
+        height = width;  // a single number is a square input
+    }
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    size = alignInputSize(cv::Size(width, height));
+    return true;
+}
+
+// InputSizeController class implementation
+InputSizeController::InputSizeController(const InputSizeConfig& cfg)
+    : config(cfg), use_large(!cfg.auto_select), switch_count(0), runs_at_size(0), quiet_runs(0),
+      probing(false), large_forward_ms(0) {
+    config.small_size = alignInputSize(config.small_size);
+    config.large_size = alignInputSize(config.large_size);
+}
+
+void InputSizeController::select(bool large) {
+    if (large == use_large) return;
+    use_large = large;
+    ++switch_count;
+    runs_at_size = 0;
+    quiet_runs = 0;
+    probing = false;
+    if (large) {
+        // Judge the new stint on its own forward times, not on an average from long ago
+        large_forward_ms = 0;
+    }
+    const cv::Size size = current();
+    YOLO_LOG(LogLevel::Debug, "Input size -> " << size.width << "x" << size.height);
+}
+
+void InputSizeController::update(const std::vector<Detection>& detections, const cv::Size& frame_size,
+                                 const cv::Size& input_size, double forward_ms) {
+    if (!config.auto_select || frame_size.area() <= 0) return;
+    // Results of a run started before the last switch say nothing about the new size
+    if (input_size != current()) return;
+    ++runs_at_size;
+
+    // Size of each object as the network would see it at small_size
+    const double kx = static_cast<double>(config.small_size.width) / frame_size.width;
+    const double ky = static_cast<double>(config.small_size.height) / frame_size.height;
+    bool small_object = false;
+    for (const Detection& detection : detections) {
+        if (std::min(detection.bbox.width * kx, detection.bbox.height * ky) < config.min_object_px) {
+            small_object = true;
+            break;
+        }
+    }
+
+    if (use_large) {
+        if (forward_ms > 0) {
+            large_forward_ms = large_forward_ms > 0 ? 0.9 * large_forward_ms + 0.1 * forward_ms : forward_ms;
+        }
+        const bool over_budget = config.latency_budget_ms > 0 && large_forward_ms > config.latency_budget_ms;
+        quiet_runs = small_object ? 0 : quiet_runs + 1;
+        probing = probing && !small_object;
+        if (over_budget || quiet_runs >= (probing ? 1 : config.hold_frames)) {
+            select(false);
+        }
+        return;
+    }
+    // Over budget only the periodic probe goes up, which also re-measures the latency
+    const bool over_budget = config.latency_budget_ms > 0 && large_forward_ms > config.latency_budget_ms;
+    const bool probe = config.probe_interval > 0 && runs_at_size >= config.probe_interval;
+    if (probe || (small_object && !over_budget)) {
+        select(true);
+        probing = !small_object;
+    }
+}
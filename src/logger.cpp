@@ -0,0 +1,57 @@
+#include "logger.h"
+#include <cstdio>
+
+namespace {
+
+const char* levelTag(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "[debug] ";
+        case LogLevel::Info: return "[info] ";
+        case LogLevel::Warning: return "[warn] ";
+        default: return "[error] ";
+    }
+}
+
+} // namespace
+
+AsyncLogger& AsyncLogger::instance() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+AsyncLogger::AsyncLogger()
+    : lines(4096, QueuePolicy::DropOldest), min_level(static_cast<int>(LogLevel::Info)) {
+    writer = std::thread(&AsyncLogger::writerLoop, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    shutdown();
+}
+
+void AsyncLogger::log(LogLevel level, const std::string& message) {
+    if (!enabled(level)) {
+        return;
+    }
+    lines.push(levelTag(level) + message);
+}
+
+void AsyncLogger::shutdown() {
+    lines.close();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void AsyncLogger::writerLoop() {
+    // stderr is unbuffered, so gather the whole backlog into one write
+    std::string line;
+    std::string batch;
+    while (lines.pop(line)) {
+        batch.clear();
+        do {
+            batch += line;
+            batch += '\n';
+        } while (lines.tryPop(line));
+        std::fwrite(batch.data(), 1, batch.size(), stderr);
+    }
+}
@@ -2,11 +2,17 @@
 #include <string>
 #include <opencv2/opencv.hpp>
 #include "inference.h"
-#include "read_json.h"
+#include "stream_server.h"
+#include "input_size.h"
+#include "metrics.h"
+#include "logger.h"
 
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <algorithm>
+#include <sstream>
+#include <cstdio>
 
 int main(int argc, char** argv) {
     std::unordered_map<std::string, std::string> args;
@@ -15,22 +21,67 @@ int main(int argc, char** argv) {
     }
 
     // Required arguments
-    if ((args.find("--image") == args.end() && args.find("--camera") == args.end()) && args.find("--rtsp_url") == args.end()||
-        args.find("--weights") == args.end() || args.find("--cfg") == args.end() || args.find("--intrusion") == args.end()) {
+    if ((args.find("--image") == args.end() && args.find("--camera") == args.end()) && args.find("--rtsp_url") == args.end() &&
+        args.find("--streams") == args.end() ||
+        args.find("--weights") == args.end() ||
+        (args.find("--cfg") == args.end() && !YOLOUtils::isOnnxModel(args["--weights"])) || args.find("--intrusion") == args.end()) {
         std::cout << "Usage:\n"
                   << "  " << argv[0] << " --image <image_path>\n"
                   << "  OR\n"
                   << "  " << argv[0] << " --camera <camera_index>\n"
                   << "  OR\n"
                   << "  " << argv[0] << " --rtsp_url <rtsp_url>\n"
+                  << "  OR\n"
+                  << "  " << argv[0] << " --streams <stream_manifest.json>\n"
                   << "Required:\n"
-                  << "  --weights <weights_path>\n"
-                  << "  --cfg <config_path>\n"
+                  << "  --weights <weights_path | model.onnx>\n"
+                  << "  --cfg <config_path> (Darknet weights only)\n"
                   << "Optional:\n"
                   << "  --names <class_names_path> (default: coco.names)\n"
                   << "  --conf <confidence_threshold> (default: 0.25)\n"
                   << "  --nms <nms_threshold> (default: 0.4)\n"
-                  << "  --intrusion <enable_intrusion> (default: false)\n";
+                  << "  --nms_method <hard|soft|diou> (default: hard)\n"
+                  << "  --nms_agnostic <suppress_across_classes> (default: false)\n"
+                  << "  --nms_top_k <candidates_before_nms> (default: 1000, 0 = all)\n"
+                  << "  --intrusion <enable_intrusion> (default: false)\n"
+                  << "  --zones <zones_json_path> (default: features/boxes.json)\n"
+                  << "  --letterbox <keep_aspect_ratio> (default: false)\n"
+                  << "  --backend <opencv|openvino|timvx|cuda|vulkan> (default: opencv)\n"
+                  << "  --target <auto|cpu|cpu_fp16|opencl|opencl_fp16|npu|cuda|cuda_fp16> (default: cpu)\n"
+                  << "  --threads <opencv_threads> (default: all cores)\n"
+                  << "  --affinity <cpu_list, e.g. 0-3,6> (default: unpinned)\n"
+                  << "  --warmup <forward_pass_at_startup> (default: true)\n"
+                  << "  --input_size <416|640x384|auto> (default: model input size)\n"
+                  << "  --auto_sizes <small,large> (default: 320,model input size)\n"
+                  << "  --latency_budget_ms <max_forward_ms_at_large_size> (default: 0 = none)\n"
+                  << "  --headless <no_display_window> (default: false)\n"
+                  << "  --output <jsonl|bin>:<stdout|unix:socket_path|file>[,...] (default: none)\n"
+                  << "  --save <annotated_video_path> (default: none)\n"
+                  << "  --log_level <debug|info|warning|error> (default: info)\n"
+                  << "  --workers <num_inference_threads> (default: 1)\n"
+                  << "  --queue_size <frames_per_stage_queue> (default: 4)\n"
+                  << "  --queue_policy <drop|block> (default: drop)\n"
+                  << "  --motion_gate <skip_inference_on_static_frames> (default: true)\n"
+                  << "  --motion_ratio <moving_pixel_fraction> (default: 0.002)\n"
+                  << "  --max_staleness_ms <max_ms_between_inferences> (default: 1000)\n"
+                  << "  --tracking <assign_track_ids> (default: true)\n"
+                  << "  --tiling <off|full|zones> (default: off)\n"
+                  << "  --tile_size <tile_pixels> (default: network input size)\n"
+                  << "  --tile_overlap <fraction> (default: 0.2)\n"
+                  << "  --tile_workers <parallel_tile_detectors> (default: 1)\n"
+                  << "  --capture_backend <auto|ffmpeg|gstreamer> (default: auto)\n"
+                  << "  --hw_decode <use_vaapi_when_present> (default: true)\n"
+                  << "  --decode_threads <ffmpeg_decoder_threads> (default: 0 = decoder default)\n"
+                  << "  --decode_scale <off|input|WxH> (default: off, gstreamer only)\n"
+                  << "  --frame_buffers <recycled_capture_frames> (default: 12)\n"
+                  << "  --open_timeout_ms <network_open_timeout> (default: 10000)\n"
+                  << "  --read_timeout_ms <network_read_timeout> (default: 5000)\n"
+                  << "  --reconnect_initial_ms <first_retry_delay> (default: 500)\n"
+                  << "  --reconnect_max_ms <backoff_ceiling> (default: 30000)\n"
+                  << "  --max_reconnects <attempts_before_giving_up> (default: 0 = never)\n"
+                  << "  --metrics_port <http_port_for_/metrics> (default: 0 = off)\n"
+                  << "  --metrics_json <snapshot_path> (default: none)\n"
+                  << "  --metrics_interval_sec <json_snapshot_period> (default: 10)\n";
         }
 
     // Assign required paths
@@ -39,6 +90,9 @@ int main(int argc, char** argv) {
     bool enable_intrusion = args.count("--intrusion") 
         ? (args["--intrusion"] == "true" || args["--intrusion"] == "1") 
         : false;
+    std::string zones_path = args.count("--zones")
+        ? args["--zones"]
+        : "features/boxes.json";
     // Optional with defaults
     std::string class_names_path = args.count("--names") 
         ? args["--names"] 
@@ -52,26 +106,200 @@ int main(int argc, char** argv) {
         ? std::stof(args["--nms"]) 
         : 0.4f;
 
+    // Pipeline threading options for camera / RTSP input
+    PipelineConfig pipeline_config;
+    if (args.count("--workers")) {
+        pipeline_config.num_workers = std::max(1, std::stoi(args["--workers"]));
+    }
+    if (args.count("--queue_size")) {
+        pipeline_config.queue_capacity = static_cast<size_t>(std::max(1, std::stoi(args["--queue_size"])));
+    }
+    if (args.count("--queue_policy")) {
+        pipeline_config.queue_policy = (args["--queue_policy"] == "block")
+            ? QueuePolicy::Block
+            : QueuePolicy::DropOldest;
+    }
+    if (args.count("--motion_gate")) {
+        pipeline_config.motion.enabled = (args["--motion_gate"] == "true" || args["--motion_gate"] == "1");
+    }
+    if (args.count("--motion_ratio")) {
+        pipeline_config.motion.motion_ratio = std::stod(args["--motion_ratio"]);
+    }
+    if (args.count("--max_staleness_ms")) {
+        pipeline_config.motion.max_staleness_ms = std::stod(args["--max_staleness_ms"]);
+    }
+    if (args.count("--tracking")) {
+        pipeline_config.tracking = (args["--tracking"] == "true" || args["--tracking"] == "1");
+    }
+    if (args.count("--tiling")) {
+        pipeline_config.tiling.enabled = args["--tiling"] == "full" || args["--tiling"] == "zones";
+        pipeline_config.tiling.zones_only = args["--tiling"] == "zones";
+    }
+    if (args.count("--tile_size")) {
+        int tile = std::stoi(args["--tile_size"]);
+        pipeline_config.tiling.tile_size = cv::Size(tile, tile);
+    }
+    if (args.count("--tile_overlap")) {
+        pipeline_config.tiling.overlap = std::stof(args["--tile_overlap"]);
+    }
+    if (args.count("--tile_workers")) {
+        pipeline_config.tiling.workers = std::max(1, std::stoi(args["--tile_workers"]));
+    }
+
+    // Output sinks
+    OutputConfig output_config;
+    output_config.display = !(args.count("--headless") &&
+                              (args["--headless"] == "true" || args["--headless"] == "1"));
+    if (args.count("--output")) {
+        std::stringstream outputs(args["--output"]);
+        std::string output;
+        while (std::getline(outputs, output, ',')) {
+            if (!output.empty()) output_config.records.push_back(output);
+        }
+    }
+    if (args.count("--save")) {
+        output_config.video_path = args["--save"];
+    }
+    if (args.count("--log_level")) {
+        const std::string& level = args["--log_level"];
+        AsyncLogger::instance().setLevel(level == "debug" ? LogLevel::Debug
+                                         : level == "warning" ? LogLevel::Warning
+                                         : level == "error" ? LogLevel::Error
+                                         : LogLevel::Info);
+    }
+
     // Setup detector
     YOLOConfig config(model_path, config_path);
     config.class_names = YOLOUtils::loadClassNames(class_names_path);
     config.confidence_threshold = confidence_threshold;
     config.nms_threshold = nms_threshold;
+    if (args.count("--nms_method")) {
+        config.nms_method = parseNmsMethod(args["--nms_method"]);
+    }
+    if (args.count("--nms_agnostic")) {
+        config.nms_per_class = !(args["--nms_agnostic"] == "true" || args["--nms_agnostic"] == "1");
+    }
+    if (args.count("--nms_top_k")) {
+        config.nms_top_k = std::stoi(args["--nms_top_k"]);
+    }
+    config.letterbox = args.count("--letterbox")
+        ? (args["--letterbox"] == "true" || args["--letterbox"] == "1")
+        : false;
+    if (args.count("--backend")) {
+        config.backend = YOLOUtils::parseBackend(args["--backend"]);
+    }
+    if (args.count("--target")) {
+        config.target = YOLOUtils::parseTarget(args["--target"]);
+    }
+    if (args.count("--threads")) {
+        config.num_threads = std::stoi(args["--threads"]);
+    }
+    if (args.count("--affinity")) {
+        config.cpu_affinity = YOLOUtils::parseCpuList(args["--affinity"]);
+    }
+    if (args.count("--warmup")) {
+        config.warmup = (args["--warmup"] == "true" || args["--warmup"] == "1");
+    }
+    // Fixed network input size, or automatic switching between two sizes
+    pipeline_config.input_size.large_size = config.input_size;
+    if (args.count("--input_size")) {
+        if (args["--input_size"] == "auto") {
+            pipeline_config.input_size.auto_select = true;
+        } else if (parseInputSize(args["--input_size"], config.input_size)) {
+            pipeline_config.input_size.large_size = config.input_size;
+        } else {
+            std::cerr << "Invalid --input_size: " << args["--input_size"] << std::endl;
+            return 1;
+        }
+    }
+    if (args.count("--auto_sizes")) {
+        std::string sizes = args["--auto_sizes"];
+        size_t comma = sizes.find(',');
+        if (comma == std::string::npos ||
+            !parseInputSize(sizes.substr(0, comma), pipeline_config.input_size.small_size) ||
+            !parseInputSize(sizes.substr(comma + 1), pipeline_config.input_size.large_size)) {
+            std::cerr << "Invalid --auto_sizes: " << sizes << std::endl;
+            return 1;
+        }
+    }
+    if (args.count("--latency_budget_ms")) {
+        pipeline_config.input_size.latency_budget_ms = std::stod(args["--latency_budget_ms"]);
+    }
+    // Capture backend; decoder-side scaling can deliver frames at the network input size
+    CaptureConfig& capture = pipeline_config.capture;
+    if (args.count("--capture_backend")) {
+        capture.backend = parseCaptureBackend(args["--capture_backend"]);
+    }
+    if (args.count("--hw_decode")) {
+        capture.hw_decode = (args["--hw_decode"] == "true" || args["--hw_decode"] == "1");
+    }
+    if (args.count("--decode_threads")) {
+        capture.decode_threads = std::max(0, std::stoi(args["--decode_threads"]));
+    }
+    if (args.count("--frame_buffers")) {
+        capture.ring_size = static_cast<size_t>(std::max(1, std::stoi(args["--frame_buffers"])));
+    }
+    if (args.count("--open_timeout_ms")) {
+        capture.open_timeout_ms = std::max(0, std::stoi(args["--open_timeout_ms"]));
+    }
+    if (args.count("--read_timeout_ms")) {
+        capture.read_timeout_ms = std::max(0, std::stoi(args["--read_timeout_ms"]));
+    }
+    // Reconnect backoff of live sources
+    if (args.count("--reconnect_initial_ms")) {
+        pipeline_config.ingest.reconnect_initial_ms = std::stoi(args["--reconnect_initial_ms"]);
+    }
+    if (args.count("--reconnect_max_ms")) {
+        pipeline_config.ingest.reconnect_max_ms = std::stoi(args["--reconnect_max_ms"]);
+    }
+    if (args.count("--max_reconnects")) {
+        pipeline_config.ingest.max_reconnects = std::max(0, std::stoi(args["--max_reconnects"]));
+    }
+    if (args.count("--decode_scale") && args["--decode_scale"] != "off") {
+        if (args["--decode_scale"] == "input") {
+            capture.scale_to = pipeline_config.input_size.large_size;
+        } else if (std::sscanf(args["--decode_scale"].c_str(), "%dx%d",
+                               &capture.scale_to.width, &capture.scale_to.height) != 2 ||
+                   capture.scale_to.area() <= 0) {
+            std::cerr << "Invalid --decode_scale: " << args["--decode_scale"] << std::endl;
+            return 1;
+        }
+    }
+
+    // Prometheus endpoint and JSON snapshots of the runtime metrics
+    MetricsConfig metrics_config;
+    if (args.count("--metrics_port")) {
+        metrics_config.http_port = std::stoi(args["--metrics_port"]);
+    }
+    if (args.count("--metrics_json")) {
+        metrics_config.json_path = args["--metrics_json"];
+    }
+    if (args.count("--metrics_interval_sec")) {
+        metrics_config.json_interval_sec = std::stod(args["--metrics_interval_sec"]);
+    }
+    MetricsExporter metrics(metrics_config);
+    if (!metrics.start()) {
+        return 1;
+    }
 
     YOLODetector detector(config);
 
     // Run detection
     if (args.count("--image")) {
-        run_image_inference(args["--image"], detector);
+        run_image_inference(args["--image"], detector, output_config);
     } else if (args.count("--camera")) {
         int cam_idx = std::stoi(args["--camera"]);
-        run_camera_inference(cam_idx, detector, 5);
+        run_camera_inference(cam_idx, detector, pipeline_config, output_config);
     }
     else if (args.count("--rtsp_url")) {
-        std::cout << "Running RTSP inference on: " << args["--rtsp_url"] << std::endl;
-        run_rtsp_inference(args["--rtsp_url"], detector, 5, 
+        YOLO_LOG(LogLevel::Info, "Running RTSP inference on: " << args["--rtsp_url"]);
+        run_rtsp_inference(args["--rtsp_url"], detector,
                            enable_intrusion,
-                           "features/boxes.json");
+                           zones_path,
+                           pipeline_config,
+                           output_config);
+    } else if (args.count("--streams")) {
+        run_stream_server(args["--streams"], detector, output_config);
     } else {
         std::cerr << "No valid input source provided." << std::endl;
         return 1;
@@ -0,0 +1,352 @@
+#include "metrics.h"
+#include "logger.h"
+#include "json.hpp"
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#ifdef __linux__
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// MetricHistogram class implementation
+MetricHistogram::MetricHistogram(const std::vector<double>& upper_bounds)
+    : upper(upper_bounds), buckets(new std::atomic<uint64_t>[upper_bounds.size() + 1]), sum_micro(0) {
+    for (size_t i = 0; i <= upper.size(); ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::observe(double v) {
+    size_t bucket = 0;
+    while (bucket < upper.size() && v > upper[bucket]) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    if (v > 0) {
+        sum_micro.fetch_add(static_cast<uint64_t>(v * 1e6), std::memory_order_relaxed);
+    }
+}
+
+std::vector<uint64_t> MetricHistogram::bucketCounts() const {
+    std::vector<uint64_t> counts(upper.size() + 1);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+uint64_t MetricHistogram::count() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i <= upper.size(); ++i) {
+        total += buckets[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::vector<double> latencyBucketsMs() {
+    return {0.5, 1, 2, 5, 10, 20, 35, 50, 75, 100, 200, 500, 1000};
+}
+
+namespace {
+
+// name="value" pairs with Prometheus escaping, plus an optional extra pair
+std::string renderLabels(const MetricLabels& labels, const std::string& extra = "") {
+    std::string text;
+    for (const auto& label : labels) {
+        if (!text.empty()) text += ',';
+        text += label.first;
+        text += "=\"";
+        for (char c : label.second) {
+            if (c == '\\' || c == '"') text += '\\';
+            if (c == '\n') {
+                text += "\\n";
+                continue;
+            }
+            text += c;
+        }
+        text += '"';
+    }
+    if (!extra.empty()) {
+        if (!text.empty()) text += ',';
+        text += extra;
+    }
+    return text.empty() ? text : "{" + text + "}";
+}
+
+std::string formatNumber(double value) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.10g", value);
+    return number;
+}
+
+} // namespace
+
+// MetricsRegistry class implementation
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(const std::string& name, const std::string& help,
+                                                 const std::string& type, const MetricLabels& labels) {
+    Family& family = families[name];
+    if (family.type.empty()) {
+        family.help = help;
+        family.type = type;
+    }
+    Series& entry = family.series[renderLabels(labels)];
+    entry.labels = labels;
+    return entry;
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                        const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& entry = series(name, help, "counter", labels);
+    if (!entry.counter) entry.counter.reset(new MetricCounter());
+    return *entry.counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                                    const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& entry = series(name, help, "gauge", labels);
+    if (!entry.gauge) entry.gauge.reset(new MetricGauge());
+    return *entry.gauge;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                            const MetricLabels& labels,
+                                            const std::vector<double>& bounds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& entry = series(name, help, "histogram", labels);
+    if (!entry.histogram) entry.histogram.reset(new MetricHistogram(bounds));
+    return *entry.histogram;
+}
+
+std::string MetricsRegistry::prometheusText() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    for (const auto& item : families) {
+        const std::string& name = item.first;
+        const Family& family = item.second;
+        out << "# HELP " << name << " " << family.help << "\n";
+        out << "# TYPE " << name << " " << family.type << "\n";
+        for (const auto& entry : family.series) {
+            const Series& series = entry.second;
+            if (series.counter) {
+                out << name << entry.first << " " << series.counter->get() << "\n";
+            } else if (series.gauge) {
+                out << name << entry.first << " " << formatNumber(series.gauge->get()) << "\n";
+            } else if (series.histogram) {
+                const MetricHistogram& histogram = *series.histogram;
+                const std::vector<uint64_t> counts = histogram.bucketCounts();
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < counts.size(); ++i) {
+                    cumulative += counts[i];
+                    const std::string le = i < histogram.bounds().size()
+                        ? formatNumber(histogram.bounds()[i])
+                        : "+Inf";
+                    out << name << "_bucket" << renderLabels(series.labels, "le=\"" + le + "\"")
+                        << " " << cumulative << "\n";
+                }
+                out << name << "_sum" << entry.first << " " << formatNumber(histogram.sum()) << "\n";
+                out << name << "_count" << entry.first << " " << cumulative << "\n";
+            }
+        }
+    }
+    return out.str();
+}
+
+std::string MetricsRegistry::json() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    nlohmann::json metrics = nlohmann::json::object();
+    for (const auto& item : families) {
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto& entry : item.second.series) {
+            const Series& series = entry.second;
+            nlohmann::json value;
+            nlohmann::json labels = nlohmann::json::object();
+            for (const auto& label : series.labels) {
+                labels[label.first] = label.second;
+            }
+            value["labels"] = labels;
+            if (series.counter) {
+                value["value"] = series.counter->get();
+            } else if (series.gauge) {
+                value["value"] = series.gauge->get();
+            } else if (series.histogram) {
+                const MetricHistogram& histogram = *series.histogram;
+                const std::vector<uint64_t> counts = histogram.bucketCounts();
+                nlohmann::json buckets = nlohmann::json::object();
+                uint64_t total = 0;
+                for (size_t i = 0; i < counts.size(); ++i) {
+                    total += counts[i];
+                    buckets[i < histogram.bounds().size() ? formatNumber(histogram.bounds()[i]) : "+Inf"] = counts[i];
+                }
+                value["count"] = total;
+                value["sum"] = histogram.sum();
+                value["buckets"] = buckets;
+            }
+            list.push_back(value);
+        }
+        metrics[item.first] = list;
+    }
+    nlohmann::json snapshot;
+    snapshot["timestamp_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    snapshot["metrics"] = metrics;
+    return snapshot.dump();
+}
+
+// MetricsConfig struct implementation
+MetricsConfig::MetricsConfig() : http_port(0), json_interval_sec(10.0) {}
+
+// MetricsExporter class implementation
+MetricsExporter::MetricsExporter(const MetricsConfig& cfg)
+    : config(cfg), running(false), listen_fd(-1) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start() {
+    running = true;
+    if (config.http_port > 0) {
+#ifdef __linux__
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(config.http_port));
+        if (listen_fd < 0 ||
+            setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+            bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd, 8) != 0) {
+            YOLO_LOG(LogLevel::Error, "Could not listen for metrics on port " << config.http_port
+                      << ": " << std::strerror(errno));
+            if (listen_fd >= 0) close(listen_fd);
+            listen_fd = -1;
+            running = false;
+            return false;
+        }
+        http_thread = std::thread(&MetricsExporter::httpLoop, this);
+        YOLO_LOG(LogLevel::Info, "Serving metrics on http://0.0.0.0:" << config.http_port << "/metrics");
+#else
+        YOLO_LOG(LogLevel::Error, "The metrics endpoint is not supported on this platform");
+#endif
+    }
+    if (!config.json_path.empty() && config.json_interval_sec > 0) {
+        dump_thread = std::thread(&MetricsExporter::dumpLoop, this);
+    }
+    return true;
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(dump_mutex);
+        running = false;
+    }
+    dump_wakeup.notify_all();
+    if (http_thread.joinable()) {
+        http_thread.join();
+    }
+    if (dump_thread.joinable()) {
+        dump_thread.join();
+    }
+#ifdef __linux__
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+#endif
+}
+
+void MetricsExporter::httpLoop() {
+#ifdef __linux__
+    while (running) {
+        // Wake up now and then to notice stop()
+        pollfd listener = {listen_fd, POLLIN, 0};
+        if (poll(&listener, 1, 200) <= 0) {
+            continue;
+        }
+        int client_fd = accept(listen_fd, nullptr, nullptr);
+        if (client_fd >= 0) {
+            serveClient(client_fd);
+            close(client_fd);
+        }
+    }
+#endif
+}
+
+void MetricsExporter::serveClient(int client_fd) {
+#ifdef __linux__
+    // A scrape request fits in one small read; wait at most a second for it
+    timeval timeout = {1, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char request[1024];
+    ssize_t received = recv(client_fd, request, sizeof(request) - 1, 0);
+    if (received <= 0) {
+        return;
+    }
+    request[received] = '\0';
+
+    std::string status = "200 OK";
+    std::string body;
+    if (std::strncmp(request, "GET /metrics ", 13) == 0 || std::strncmp(request, "GET /metrics?", 13) == 0) {
+        body = MetricsRegistry::instance().prometheusText();
+    } else if (std::strncmp(request, "GET ", 4) == 0) {
+        status = "404 Not Found";
+        body = "Not found, try /metrics\n";
+    } else {
+        status = "405 Method Not Allowed";
+    }
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    const std::string data = response.str();
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(client_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += static_cast<size_t>(n);
+    }
+#else
+    (void)client_fd;
+#endif
+}
+
+void MetricsExporter::dumpLoop() {
+    std::unique_lock<std::mutex> lock(dump_mutex);
+    while (running) {
+        dump_wakeup.wait_for(lock, std::chrono::duration<double>(config.json_interval_sec),
+                             [this] { return !running; });
+        lock.unlock();
+        writeJson();
+        lock.lock();
+    }
+}
+
+void MetricsExporter::writeJson() {
+    const std::string temp_path = config.json_path + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "w");
+    if (!file) {
+        YOLO_LOG(LogLevel::Error, "Could not write metrics to " << temp_path);
+        return;
+    }
+    const std::string snapshot = MetricsRegistry::instance().json();
+    std::fwrite(snapshot.data(), 1, snapshot.size(), file);
+    std::fputc('\n', file);
+    std::fclose(file);
+    std::rename(temp_path.c_str(), config.json_path.c_str());
+}
@@ -0,0 +1,98 @@
+#include "model_source.h"
+#include "inference.h"
+#include "logger.h"
+#include <fstream>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// MappedFile class implementation
+MappedFile::MappedFile() : bytes(nullptr), length(0), mapped(false) {}
+
+MappedFile::~MappedFile() {
+#ifdef __linux__
+    if (mapped) {
+        munmap(const_cast<char*>(bytes), length);
+    }
+#endif
+}
+
+bool MappedFile::open(const std::string& path) {
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        void* address = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (address != MAP_FAILED) {
+            // The parser reads the weights front to back exactly once. Advice values are
+            // not flags, so the access pattern and the readahead are two calls.
+            madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            madvise(address, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+            bytes = static_cast<const char*>(address);
+            length = static_cast<size_t>(info.st_size);
+            mapped = true;
+            return true;
+        }
+    }
+#endif
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::streamoff file_size = file.tellg();
+    if (file_size <= 0) {
+        return false;
+    }
+    buffer.resize(static_cast<size_t>(file_size));
+    file.seekg(0);
+    if (!file.read(buffer.data(), buffer.size())) {
+        // A partial buffer would be parsed as truncated weights; stay empty instead
+        std::vector<char>().swap(buffer);
+        return false;
+    }
+    bytes = buffer.data();
+    length = buffer.size();
+    return true;
+}
+
+// ModelSource class implementation
+ModelSource::ModelSource() : onnx(false) {}
+
+std::shared_ptr<const ModelSource> ModelSource::open(const std::string& model_path,
+                                                     const std::string& config_path) {
+    std::shared_ptr<ModelSource> source(new ModelSource());
+    source->model_path = model_path;
+    source->config_path = config_path;
+    source->onnx = YOLOUtils::isOnnxModel(model_path);
+    if (!source->model.open(model_path)) {
+        YOLO_LOG(LogLevel::Warning, "Could not map " << model_path << ", loading it by path");
+    }
+    if (!source->onnx && !config_path.empty() && !source->config.open(config_path)) {
+        YOLO_LOG(LogLevel::Warning, "Could not map " << config_path << ", loading it by path");
+    }
+    return source;
+}
+
+cv::dnn::Net ModelSource::createNet() const {
+    if (onnx) {
+        // Quantized (QDQ) models load the same way and are run in int8 by the OpenCV backend
+        return model.empty() ? cv::dnn::readNetFromONNX(model_path)
+                             : cv::dnn::readNetFromONNX(model.data(), model.size());
+    }
+    if (config_path.empty()) {
+        // A lone Darknet path is the .cfg, as with readNetFromDarknet(path)
+        return model.empty() ? cv::dnn::readNetFromDarknet(model_path)
+                             : cv::dnn::readNetFromDarknet(model.data(), model.size());
+    }
+    if (model.empty() || config.empty()) {
+        return cv::dnn::readNetFromDarknet(config_path, model_path);
+    }
+    return cv::dnn::readNetFromDarknet(config.data(), config.size(), model.data(), model.size());
+}
@@ -0,0 +1,59 @@
+#include "motion_gate.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+// MotionGateConfig struct implementation
+MotionGateConfig::MotionGateConfig()
+    : enabled(true), analysis_width(160), pixel_threshold(25), motion_ratio(0.002),
+      max_staleness_ms(1000.0) {}
+
+// MotionGate class implementation
+MotionGate::MotionGate(const MotionGateConfig& cfg)
+    : config(cfg), last_motion(1.0), last_detect_ticks(0), reference_index(0), has_reference(false) {}
+
+bool MotionGate::test(const cv::Mat& frame, cv::Mat& sample) {
+    sample.release();
+    if (!config.enabled || frame.empty()) {
+        return true;
+    }
+    const int64_t now = cv::getTickCount();
+
+    // INTER_AREA averages whole blocks, which also filters out sensor noise
+    int width = std::min(std::max(config.analysis_width, 16), frame.cols);
+    int height = std::max(1, cvRound(static_cast<double>(frame.rows) * width / frame.cols));
+    cv::resize(frame, small, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (small.channels() == 3) {
+        cv::cvtColor(small, sample, cv::COLOR_BGR2GRAY);
+    } else if (small.channels() == 4) {
+        cv::cvtColor(small, sample, cv::COLOR_BGRA2GRAY);
+    } else {
+        small.copyTo(sample);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    double stale_ms = (now - last_detect_ticks) * 1000.0 / cv::getTickFrequency();
+    if (!reference.empty() && reference.size() == sample.size() && stale_ms < config.max_staleness_ms) {
+        cv::absdiff(sample, reference, diff);
+        cv::threshold(diff, diff, config.pixel_threshold, 255, cv::THRESH_BINARY);
+        last_motion = static_cast<double>(cv::countNonZero(diff)) / diff.total();
+        if (last_motion < config.motion_ratio) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MotionGate::commit(const cv::Mat& sample, uint64_t index, int64_t capture_ticks) {
+    if (sample.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    // With several workers frames finish out of order; keep the newest reference
+    if (has_reference && index < reference_index) {
+        return;
+    }
+    reference = sample;
+    reference_index = index;
+    last_detect_ticks = capture_ticks;
+    has_reference = true;
+}
@@ -0,0 +1,205 @@
+#include "nms.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+
+NmsMethod parseNmsMethod(const std::string& name) {
+    if (name == "soft") return NmsMethod::Soft;
+    if (name == "diou") return NmsMethod::DIoU;
+    return NmsMethod::Hard;
+}
+
+const char* nmsMethodName(NmsMethod method) {
+    switch (method) {
+        case NmsMethod::Soft: return "soft";
+        case NmsMethod::DIoU: return "diou";
+        default: return "hard";
+    }
+}
+
+// BoxSuppressor class implementation
+BoxSuppressor::BoxSuppressor()
+    : method(NmsMethod::Hard), per_class(true), top_k(0), soft_sigma(0.5f) {}
+
+void BoxSuppressor::configure(NmsMethod nms_method, bool per_class_nms, int max_candidates,
+                              float sigma) {
+    method = nms_method;
+    per_class = per_class_nms;
+    top_k = std::max(0, max_candidates);
+    soft_sigma = sigma > 0 ? sigma : 0.5f;
+}
+
+void BoxSuppressor::run(const std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                        const std::vector<int>& class_ids, float score_threshold,
+                        float iou_threshold, std::vector<int>& indices) {
+    indices.clear();
+    order.clear();
+    const int n = static_cast<int>(boxes.size());
+    for (int i = 0; i < n; ++i) {
+        if (confidences[i] >= score_threshold) {
+            order.push_back(i);
+        }
+    }
+    if (order.empty()) {
+        return;
+    }
+
+    // Cap the candidate count with a partial selection; the order inside the cap
+    // does not matter because buckets pick their best box by scanning
+    if (top_k > 0 && static_cast<int>(order.size()) > top_k) {
+        std::nth_element(order.begin(), order.begin() + top_k, order.end(),
+                         [&confidences](int a, int b) { return confidences[a] > confidences[b]; });
+        order.resize(top_k);
+    }
+
+    if (!per_class) {
+        suppressBucket(boxes, confidences, order.data(), static_cast<int>(order.size()),
+                       score_threshold, iou_threshold, indices);
+        return;
+    }
+
+    // Counting pass: group the candidates by class id in O(n)
+    int max_class = 0;
+    for (int idx : order) {
+        max_class = std::max(max_class, class_ids[idx]);
+    }
+    bucket_start.assign(max_class + 2, 0);
+    for (int idx : order) {
+        ++bucket_start[std::max(0, class_ids[idx]) + 1];
+    }
+    for (int c = 0; c <= max_class; ++c) {
+        bucket_start[c + 1] += bucket_start[c];
+    }
+    grouped.resize(order.size());
+    for (int idx : order) {
+        grouped[bucket_start[std::max(0, class_ids[idx])]++] = idx;
+    }
+    // The scatter advanced every start to the next bucket; shift them back
+    for (int c = max_class; c > 0; --c) {
+        bucket_start[c] = bucket_start[c - 1];
+    }
+    bucket_start[0] = 0;
+
+    for (int c = 0; c <= max_class; ++c) {
+        int count = bucket_start[c + 1] - bucket_start[c];
+        if (count > 0) {
+            suppressBucket(boxes, confidences, grouped.data() + bucket_start[c], count,
+                           score_threshold, iou_threshold, indices);
+        }
+    }
+}
+
+void BoxSuppressor::suppressBucket(const std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                                   const int* bucket, int count, float score_threshold,
+                                   float iou_threshold, std::vector<int>& indices) {
+    x1.resize(count);
+    y1.resize(count);
+    x2.resize(count);
+    y2.resize(count);
+    area.resize(count);
+    scores.resize(count);
+    ids.resize(count);
+    overlap.resize(count);
+    for (int k = 0; k < count; ++k) {
+        const cv::Rect& box = boxes[bucket[k]];
+        x1[k] = static_cast<float>(box.x);
+        y1[k] = static_cast<float>(box.y);
+        x2[k] = static_cast<float>(box.x + box.width);
+        y2[k] = static_cast<float>(box.y + box.height);
+        area[k] = static_cast<float>(box.width) * box.height;
+        scores[k] = confidences[bucket[k]];
+        ids[k] = bucket[k];
+    }
+
+    const bool soft = method == NmsMethod::Soft;
+    int remaining = count;
+    while (remaining > 0) {
+        // Best remaining box by a linear scan: no sort needed, and Soft-NMS
+        // reorders the scores after every selection anyway
+        int best = static_cast<int>(std::max_element(scores.begin(), scores.begin() + remaining) -
+                                    scores.begin());
+        if (scores[best] < score_threshold) {
+            break;
+        }
+        indices.push_back(ids[best]);
+        if (soft) {
+            confidences[ids[best]] = scores[best];
+        }
+        const float bx1 = x1[best], by1 = y1[best], bx2 = x2[best], by2 = y2[best];
+        const float barea = area[best];
+        scores[best] = -1.f; // never survives the compaction below
+
+        computeOverlap(bx1, by1, bx2, by2, barea, remaining);
+
+        // Compact the survivors to the front of the arrays
+        int kept = 0;
+        for (int k = 0; k < remaining; ++k) {
+            if (scores[k] < 0) {
+                continue;
+            }
+            float score = scores[k];
+            if (soft) {
+                score *= std::exp(-(overlap[k] * overlap[k]) / soft_sigma);
+                if (score < score_threshold) continue;
+            } else if (overlap[k] > iou_threshold) {
+                continue;
+            }
+            x1[kept] = x1[k];
+            y1[kept] = y1[k];
+            x2[kept] = x2[k];
+            y2[kept] = y2[k];
+            area[kept] = area[k];
+            scores[kept] = score;
+            ids[kept] = ids[k];
+            ++kept;
+        }
+        remaining = kept;
+    }
+}
+
+void BoxSuppressor::computeOverlap(float bx1, float by1, float bx2, float by2, float barea,
+                                   int count) {
+    const bool diou = method == NmsMethod::DIoU;
+    int k = 0;
+#if CV_SIMD
+    const int lanes = CV_SIMD_WIDTH / static_cast<int>(sizeof(float));
+    const cv::v_float32 vx1 = cv::vx_setall_f32(bx1), vy1 = cv::vx_setall_f32(by1);
+    const cv::v_float32 vx2 = cv::vx_setall_f32(bx2), vy2 = cv::vx_setall_f32(by2);
+    const cv::v_float32 varea = cv::vx_setall_f32(barea);
+    const cv::v_float32 zero = cv::vx_setzero_f32();
+    const cv::v_float32 half = cv::vx_setall_f32(0.5f);
+    const cv::v_float32 eps = cv::vx_setall_f32(1e-6f);
+    for (; k <= count - lanes; k += lanes) {
+        cv::v_float32 ox1 = cv::vx_load(&x1[k]), oy1 = cv::vx_load(&y1[k]);
+        cv::v_float32 ox2 = cv::vx_load(&x2[k]), oy2 = cv::vx_load(&y2[k]);
+        cv::v_float32 iw = cv::v_max(cv::v_min(vx2, ox2) - cv::v_max(vx1, ox1), zero);
+        cv::v_float32 ih = cv::v_max(cv::v_min(vy2, oy2) - cv::v_max(vy1, oy1), zero);
+        cv::v_float32 inter = iw * ih;
+        cv::v_float32 iou = inter / cv::v_max(varea + cv::vx_load(&area[k]) - inter, eps);
+        if (diou) {
+            // Penalty: squared centre distance over the squared enclosing diagonal
+            cv::v_float32 dx = (vx1 + vx2 - ox1 - ox2) * half;
+            cv::v_float32 dy = (vy1 + vy2 - oy1 - oy2) * half;
+            cv::v_float32 cw = cv::v_max(vx2, ox2) - cv::v_min(vx1, ox1);
+            cv::v_float32 ch = cv::v_max(vy2, oy2) - cv::v_min(vy1, oy1);
+            iou = iou - (dx * dx + dy * dy) / cv::v_max(cw * cw + ch * ch, eps);
+        }
+        cv::v_store(&overlap[k], iou);
+    }
+    cv::vx_cleanup();
+#endif
+    for (; k < count; ++k) {
+        float iw = std::max(std::min(bx2, x2[k]) - std::max(bx1, x1[k]), 0.f);
+        float ih = std::max(std::min(by2, y2[k]) - std::max(by1, y1[k]), 0.f);
+        float inter = iw * ih;
+        float iou = inter / std::max(barea + area[k] - inter, 1e-6f);
+        if (diou) {
+            float dx = (bx1 + bx2 - x1[k] - x2[k]) * 0.5f;
+            float dy = (by1 + by2 - y1[k] - y2[k]) * 0.5f;
+            float cw = std::max(bx2, x2[k]) - std::min(bx1, x1[k]);
+            float ch = std::max(by2, y2[k]) - std::min(by1, y1[k]);
+            iou -= (dx * dx + dy * dy) / std::max(cw * cw + ch * ch, 1e-6f);
+        }
+        overlap[k] = iou;
+    }
+}
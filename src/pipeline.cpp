@@ -0,0 +1,271 @@
+#include "pipeline.h"
+#include "logger.h"
+#include "tiling.h"
+#include "metrics.h"
+
+// PipelineConfig struct implementation
+PipelineConfig::PipelineConfig()
+    : num_workers(1), queue_capacity(4), queue_policy(QueuePolicy::DropOldest),
+      tracking(true), stats_interval_sec(5.0) {}
+
+namespace {
+
+// Process-wide pipeline metrics, registered on first use
+struct PipelineMetrics {
+    MetricCounter& captured;
+    MetricCounter& inferred;
+    MetricCounter& skipped;
+    MetricCounter& late;
+    MetricCounter& capture_drops;
+    MetricCounter& result_drops;
+    MetricGauge& capture_depth;
+    MetricGauge& result_depth;
+    MetricHistogram& latency_ms;
+
+    PipelineMetrics()
+        : captured(registry().counter("yolo_frames_captured_total", "Frames read from the source")),
+          inferred(registry().counter("yolo_frames_inferred_total", "Frames run through the detector")),
+          skipped(registry().counter("yolo_frames_skipped_total",
+                                     "Frames rendered without inference (no motion)")),
+          late(registry().counter("yolo_frames_late_total", "Frames finished after a newer one was rendered")),
+          capture_drops(registry().counter("yolo_frames_dropped_total", "Frames dropped by a full queue",
+                                           {{"queue", "capture"}})),
+          result_drops(registry().counter("yolo_frames_dropped_total", "Frames dropped by a full queue",
+                                          {{"queue", "result"}})),
+          capture_depth(registry().gauge("yolo_queue_depth", "Frames waiting in a pipeline queue",
+                                         {{"queue", "capture"}})),
+          result_depth(registry().gauge("yolo_queue_depth", "Frames waiting in a pipeline queue",
+                                        {{"queue", "result"}})),
+          latency_ms(registry().histogram("yolo_frame_latency_ms",
+                                          "Capture to render latency per frame in milliseconds")) {}
+
+    static MetricsRegistry& registry() { return MetricsRegistry::instance(); }
+    static PipelineMetrics& get() {
+        static PipelineMetrics metrics;
+        return metrics;
+    }
+};
+
+} // namespace
+
+InferencePipeline::InferencePipeline(StreamIngestor& capture, YOLODetector& detector,
+                                     const PipelineConfig& cfg)
+    : source(capture), config(cfg),
+      capture_queue(cfg.queue_capacity, cfg.queue_policy),
+      result_queue(cfg.queue_capacity, cfg.queue_policy),
+      running(false), active_workers(0), frames_captured(0), frames_processed(0),
+      frames_rendered(0), late_frames(0), frames_reused(0),
+      start_ticks(cv::getTickCount()), motion_gate(cfg.motion), input_sizes(cfg.input_size) {
+    if (config.input_size.auto_select && config.tiling.enabled) {
+        YOLO_LOG(LogLevel::Warning, "Automatic input size is not used with tiling");
+    }
+
+    // YOLODetector keeps per-call scratch buffers, so every worker needs its own instance
+    detectors.push_back(&detector);
+    for (int i = 1; i < config.num_workers; ++i) {
+        owned_detectors.push_back(detector.clone());
+        detectors.push_back(owned_detectors.back().get());
+    }
+    // Build both networks now rather than on the first switch in the middle of the stream
+    if (config.input_size.auto_select && !config.tiling.enabled) {
+        for (YOLODetector* worker : detectors) {
+            worker->prepareInputSize(config.input_size.small_size);
+            worker->prepareInputSize(config.input_size.large_size);
+        }
+    }
+}
+
+InferencePipeline::~InferencePipeline() {
+    stop();
+    join();
+}
+
+void InferencePipeline::run(const RenderCallback& render) {
+    running = true;
+    start_ticks = cv::getTickCount();
+    active_workers = static_cast<int>(detectors.size());
+    capture_thread = std::thread(&InferencePipeline::captureLoop, this);
+    for (YOLODetector* detector : detectors) {
+        worker_threads.emplace_back(&InferencePipeline::inferenceLoop, this, detector);
+    }
+
+    const double tick_freq = cv::getTickFrequency();
+    int64_t last_report = cv::getTickCount();
+    uint64_t last_index = 0;
+    bool rendered_any = false;
+    uint64_t last_tracked_index = 0;
+    std::vector<Detection> last_detections;
+    uint64_t last_detections_index = 0;
+    PipelineMetrics& metrics = PipelineMetrics::get();
+    size_t capture_drops = 0;
+    size_t result_drops = 0;
+    FramePacket packet;
+    while (result_queue.pop(packet)) {
+        // Queue counters are sampled here, once per frame, rather than inside the queues
+        metrics.capture_depth.set(static_cast<double>(capture_queue.size()));
+        metrics.result_depth.set(static_cast<double>(result_queue.size()));
+        const size_t capture_dropped = capture_queue.dropped();
+        const size_t result_dropped = result_queue.dropped();
+        metrics.capture_drops.inc(capture_dropped - capture_drops);
+        metrics.result_drops.inc(result_dropped - result_drops);
+        capture_drops = capture_dropped;
+        result_drops = result_dropped;
+        // Keep the newest detections around for frames the motion gate let through
+        if (packet.run_detector) {
+            if (last_detections.empty() || packet.index >= last_detections_index) {
+                // The controller counts runs in frame order, so late results are left out
+                input_sizes.update(packet.detections, packet.frame.size(), packet.input_size, packet.forward_ms);
+                last_detections = packet.detections;
+                last_detections_index = packet.index;
+            }
+        }
+        // With several workers frames can finish out of order; never show an older frame
+        if (rendered_any && packet.index < last_index) {
+            ++late_frames;
+            metrics.late.inc();
+            continue;
+        }
+        if (config.tracking) {
+            // The tracker steps once per source frame, including dropped ones
+            int elapsed = rendered_any ? static_cast<int>(packet.index - last_tracked_index) : 1;
+            last_tracked_index = packet.index;
+            if (packet.run_detector) {
+                tracker.update(packet.detections, elapsed);
+            } else {
+                packet.detections = tracker.predict(elapsed);
+                ++frames_reused;
+                metrics.skipped.inc();
+            }
+        } else if (!packet.run_detector) {
+            packet.detections = last_detections;
+            ++frames_reused;
+            metrics.skipped.inc();
+        }
+        rendered_any = true;
+        last_index = packet.index;
+        ++frames_rendered;
+        if (!render(packet)) {
+            break;
+        }
+        metrics.latency_ms.observe((cv::getTickCount() - packet.capture_ticks) * 1000.0 / tick_freq);
+
+        int64_t now = cv::getTickCount();
+        if (config.stats_interval_sec > 0 &&
+            (now - last_report) / tick_freq >= config.stats_interval_sec) {
+            printPipelineStats(getStats());
+            last_report = now;
+        }
+    }
+    stop();
+    join();
+}
+
+void InferencePipeline::stop() {
+    running = false;
+    capture_queue.close();
+    result_queue.close();
+}
+
+void InferencePipeline::join() {
+    if (capture_thread.joinable()) {
+        capture_thread.join();
+    }
+    for (auto& worker : worker_threads) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    worker_threads.clear();
+}
+
+void InferencePipeline::captureLoop() {
+    while (running) {
+        FramePacket packet;
+        // The timeout only lets the loop notice stop() while a stream is reconnecting
+        if (!source.read(packet.frame, 200)) {
+            if (source.finished()) {
+                YOLO_LOG(LogLevel::Info, "Source ended, stopping capture.");
+                break;
+            }
+            continue;
+        }
+        packet.index = frames_captured++;
+        packet.capture_ticks = cv::getTickCount();
+        PipelineMetrics::get().captured.inc();
+        packet.run_detector = motion_gate.test(packet.frame, packet.motion_sample);
+        if (!capture_queue.push(std::move(packet))) break;
+    }
+    capture_queue.close();
+}
+
+void InferencePipeline::inferenceLoop(YOLODetector* detector) {
+    std::unique_ptr<TiledDetector> tiled;
+    if (config.tiling.enabled) {
+        tiled.reset(new TiledDetector(*detector, config.tiling));
+    }
+    // Tiles are cut to the input size, so tiling keeps the configured one
+    const bool adaptive = input_sizes.enabled() && !tiled;
+    FramePacket packet;
+    while (capture_queue.pop(packet)) {
+        if (packet.run_detector) {
+            if (adaptive) {
+                detector->setInputSize(input_sizes.current());
+            }
+            packet.detections = tiled ? tiled->detect(packet.frame) : detector->detect(packet.frame);
+            packet.input_size = detector->getConfig().input_size;
+            packet.forward_ms = detector->getLastTimings().forward_ms;
+            // Only now is the frame what the detector last saw; a dropped one never gets here
+            motion_gate.commit(packet.motion_sample, packet.index, packet.capture_ticks);
+            ++frames_processed;
+            PipelineMetrics::get().inferred.inc();
+        }
+        if (!result_queue.push(std::move(packet))) break;
+    }
+    // The last worker out tells the render stage that no more results are coming
+    if (--active_workers == 0) {
+        result_queue.close();
+    }
+}
+
+PipelineStats InferencePipeline::getStats() const {
+    PipelineStats stats;
+    stats.frames_captured = frames_captured;
+    stats.frames_processed = frames_processed;
+    stats.frames_rendered = frames_rendered;
+    stats.late_frames = late_frames;
+    stats.frames_reused = frames_reused;
+    stats.ingest = source.getStats();
+    stats.frames_drained = stats.ingest.frames_overwritten;
+    stats.frame_allocations = source.frameAllocations();
+    stats.input_size_switches = input_sizes.switches();
+    stats.input_size = input_sizes.enabled() && !config.tiling.enabled
+        ? input_sizes.current()
+        : detectors[0]->getConfig().input_size;
+    stats.capture_queue_depth = capture_queue.size();
+    stats.capture_queue_drops = capture_queue.dropped();
+    stats.result_queue_depth = result_queue.size();
+    stats.result_queue_drops = result_queue.dropped();
+    double elapsed = (cv::getTickCount() - start_ticks) / cv::getTickFrequency();
+    stats.fps = elapsed > 0 ? stats.frames_rendered / elapsed : 0.0;
+    return stats;
+}
+
+void printPipelineStats(const PipelineStats& stats) {
+    YOLO_LOG(LogLevel::Info, "[pipeline] fps=" << stats.fps
+              << " captured=" << stats.frames_captured
+              << " processed=" << stats.frames_processed
+              << " rendered=" << stats.frames_rendered
+              << " reused=" << stats.frames_reused
+              << " drained=" << stats.frames_drained
+              << " buffers=" << stats.frame_allocations
+              << " input=" << stats.input_size.width << "x" << stats.input_size.height
+              << " switches=" << stats.input_size_switches
+              << " | capture_q depth=" << stats.capture_queue_depth
+              << " drops=" << stats.capture_queue_drops
+              << " | result_q depth=" << stats.result_queue_depth
+              << " drops=" << stats.result_queue_drops
+              << " | late=" << stats.late_frames
+              << " | source=" << ingestStateName(stats.ingest.state)
+              << " reconnects=" << stats.ingest.reconnects
+              << " age_ms=" << stats.ingest.delivery_age_ms);
+}
@@ -0,0 +1,139 @@
+#include "preprocess.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+// LetterboxTransform struct implementation
+LetterboxTransform::LetterboxTransform()
+    : scale_x(1.f), scale_y(1.f), pad_x(0), pad_y(0) {}
+
+LetterboxTransform::LetterboxTransform(cv::Size image, cv::Size input, bool letterbox)
+    : image_size(image), input_size(input), pad_x(0), pad_y(0) {
+    if (letterbox) {
+        float ratio = std::min(static_cast<float>(input.width) / image.width,
+                               static_cast<float>(input.height) / image.height);
+        resized_size.width = std::min(input.width, std::max(1, static_cast<int>(std::round(image.width * ratio))));
+        resized_size.height = std::min(input.height, std::max(1, static_cast<int>(std::round(image.height * ratio))));
+        pad_x = (input.width - resized_size.width) / 2;
+        pad_y = (input.height - resized_size.height) / 2;
+    } else {
+        resized_size = input;
+    }
+    scale_x = static_cast<float>(resized_size.width) / image.width;
+    scale_y = static_cast<float>(resized_size.height) / image.height;
+}
+
+namespace {
+
+// Source taps for a bilinear resize with the same half-pixel alignment as cv::resize
+void computeTaps(int src_len, int dst_len, int stride, std::vector<int>& offsets,
+                 std::vector<float>& weights) {
+    offsets.resize(dst_len * 2);
+    weights.resize(dst_len);
+    const double ratio = static_cast<double>(src_len) / dst_len;
+    for (int d = 0; d < dst_len; ++d) {
+        double s = (d + 0.5) * ratio - 0.5;
+        int i0 = static_cast<int>(std::floor(s));
+        float f = static_cast<float>(s - i0);
+        if (i0 < 0) {
+            i0 = 0;
+            f = 0.f;
+        }
+        if (i0 >= src_len - 1) {
+            i0 = src_len - 1;
+            f = 0.f;
+        }
+        int i1 = std::min(i0 + 1, src_len - 1);
+        offsets[2 * d] = i0 * stride;
+        offsets[2 * d + 1] = i1 * stride;
+        weights[d] = f;
+    }
+}
+
+} // namespace
+
+// FusedPreprocessor class implementation
+FusedPreprocessor::FusedPreprocessor()
+    : mean(0, 0, 0), scale(1.f / 255.f), swap_rb(true), pad_value(114.f) {}
+
+void FusedPreprocessor::configure(const cv::Scalar& mean_values, double scale_factor,
+                                  bool swap_channels, float padding_value) {
+    mean = mean_values;
+    scale = static_cast<float>(scale_factor);
+    swap_rb = swap_channels;
+    pad_value = padding_value;
+}
+
+void FusedPreprocessor::pack(const cv::Mat& image, const LetterboxTransform& transform, float* dst) {
+    CV_Assert(image.depth() == CV_8U);
+    const cv::Mat* src = &image;
+    if (image.channels() != 3) {
+        cv::cvtColor(image, converted, image.channels() == 1 ? cv::COLOR_GRAY2BGR : cv::COLOR_BGRA2BGR);
+        src = &converted;
+    }
+
+    const int width = transform.input_size.width;
+    const int height = transform.input_size.height;
+    const size_t plane = static_cast<size_t>(width) * height;
+    const int resized_w = transform.resized_size.width;
+    const int resized_h = transform.resized_size.height;
+    const int pad_x = transform.pad_x;
+    const int pad_y = transform.pad_y;
+
+    computeTaps(src->cols, resized_w, 3, x_offsets, x_weights);
+    computeTaps(src->rows, resized_h, 1, y_rows, y_weights);
+
+    // Output channel c reads source channel src_channel[c]; blobFromImage semantics
+    // apply: mean is given in output channel order and subtracted before scaling
+    int src_channel[3] = {0, 1, 2};
+    if (swap_rb) {
+        src_channel[0] = 2;
+        src_channel[2] = 0;
+    }
+    float offset[3];
+    float pad_out[3];
+    for (int c = 0; c < 3; ++c) {
+        offset[c] = static_cast<float>(-mean[c] * scale);
+        pad_out[c] = static_cast<float>((pad_value - mean[c]) * scale);
+    }
+
+    // Padding bars above and below the image
+    for (int c = 0; c < 3; ++c) {
+        float* channel = dst + c * plane;
+        std::fill(channel, channel + static_cast<size_t>(pad_y) * width, pad_out[c]);
+        std::fill(channel + static_cast<size_t>(pad_y + resized_h) * width, channel + plane, pad_out[c]);
+    }
+
+    const float mul = scale;
+    const bool same_size = src->cols == resized_w && src->rows == resized_h;
+    cv::parallel_for_(cv::Range(0, resized_h), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* row0 = src->ptr<uchar>(y_rows[2 * y]);
+            const uchar* row1 = src->ptr<uchar>(y_rows[2 * y + 1]);
+            const float fy = y_weights[y];
+            const size_t out_row = static_cast<size_t>(y + pad_y) * width;
+            for (int c = 0; c < 3; ++c) {
+                float* out = dst + c * plane + out_row;
+                const int sc = src_channel[c];
+                std::fill(out, out + pad_x, pad_out[c]);
+                std::fill(out + pad_x + resized_w, out + width, pad_out[c]);
+                out += pad_x;
+                if (same_size) {
+                    // Frame already decoded at the network size: convert only
+                    for (int x = 0; x < resized_w; ++x) {
+                        out[x] = row0[3 * x + sc] * mul + offset[c];
+                    }
+                    continue;
+                }
+                for (int x = 0; x < resized_w; ++x) {
+                    const int a = x_offsets[2 * x] + sc;
+                    const int b = x_offsets[2 * x + 1] + sc;
+                    const float fx = x_weights[x];
+                    float top = row0[a] + fx * (row0[b] - row0[a]);
+                    float bottom = row1[a] + fx * (row1[b] - row1[a]);
+                    out[x] = (top + fy * (bottom - top)) * mul + offset[c];
+                }
+            }
+        }
+    });
+}
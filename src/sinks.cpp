@@ -0,0 +1,324 @@
+#include "sinks.h"
+#include "logger.h"
+#include <cstring>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// FrameResult struct implementation
+FrameResult::FrameResult()
+    : frame_index(0), timestamp_ms(0), detections(nullptr), intrusion(false),
+      events(nullptr) {}
+
+// OutputStream class implementation
+OutputStream::OutputStream()
+    : file(nullptr), socket_fd(-1), owns_file(false), dropped_records(0) {}
+
+OutputStream::~OutputStream() {
+    flush();
+    if (file && owns_file) {
+        std::fclose(file);
+    }
+#ifdef __linux__
+    if (socket_fd >= 0) {
+        close(socket_fd);
+    }
+#endif
+}
+
+bool OutputStream::open(const std::string& destination) {
+    if (destination == "stdout" || destination == "-") {
+        file = stdout;
+        owns_file = false;
+        return true;
+    }
+    if (destination.compare(0, 5, "unix:") == 0) {
+#ifdef __linux__
+        std::string path = destination.substr(5);
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            YOLO_LOG(LogLevel::Error, "Socket path too long: " << path);
+            return false;
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket_fd < 0 ||
+            connect(socket_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            YOLO_LOG(LogLevel::Error, "Could not connect to socket: " << path);
+            if (socket_fd >= 0) close(socket_fd);
+            socket_fd = -1;
+            return false;
+        }
+        return true;
+#else
+        YOLO_LOG(LogLevel::Error, "UNIX sockets are not supported on this platform");
+        return false;
+#endif
+    }
+    file = std::fopen(destination.c_str(), "wb");
+    if (!file) {
+        YOLO_LOG(LogLevel::Error, "Could not open output file: " << destination);
+        return false;
+    }
+    owns_file = true;
+    // Large buffer: records are small and frequent
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+    return true;
+}
+
+void OutputStream::write(const char* data, size_t size) {
+    if (file) {
+        std::fwrite(data, 1, size, file);
+        return;
+    }
+#ifdef __linux__
+    if (socket_fd >= 0) {
+        ssize_t sent = send(socket_fd, data, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent == static_cast<ssize_t>(size)) {
+            return;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            ++dropped_records; // reader is slow; drop instead of stalling the pipeline
+            return;
+        }
+        if (sent >= 0) {
+            // Partial write: finish the record so the byte stream stays aligned
+            const char* rest = data + sent;
+            size_t remaining = size - sent;
+            while (remaining > 0) {
+                ssize_t n = send(socket_fd, rest, remaining, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                rest += n;
+                remaining -= n;
+            }
+            if (remaining == 0) return;
+        }
+        YOLO_LOG(LogLevel::Error, "Output socket closed, dropping further records");
+        close(socket_fd);
+        socket_fd = -1;
+    }
+#endif
+    ++dropped_records;
+}
+
+void OutputStream::flush() {
+    if (file) {
+        std::fflush(file);
+    }
+}
+
+namespace {
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+template <typename T>
+void appendRaw(std::vector<char>& out, T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+} // namespace
+
+// JsonLinesSink class implementation
+JsonLinesSink::JsonLinesSink(const std::string& destination) {
+    out.open(destination);
+    line.reserve(4096);
+}
+
+bool JsonLinesSink::write(const FrameResult& result) {
+    char number[160];
+    line.clear();
+    line += "{\"stream\":";
+    appendJsonString(line, result.stream_id);
+    std::snprintf(number, sizeof(number),
+                  ",\"frame\":%llu,\"ts\":%lld,\"width\":%d,\"height\":%d,\"intrusion\":%s,\"detections\":[",
+                  static_cast<unsigned long long>(result.frame_index),
+                  static_cast<long long>(result.timestamp_ms),
+                  result.frame_size.width, result.frame_size.height,
+                  result.intrusion ? "true" : "false");
+    line += number;
+    if (result.detections) {
+        bool first = true;
+        for (const Detection& detection : *result.detections) {
+            if (!first) line += ',';
+            first = false;
+            std::snprintf(number, sizeof(number), "{\"class_id\":%d,\"class\":", detection.class_id);
+            line += number;
+            appendJsonString(line, detection.class_name);
+            std::snprintf(number, sizeof(number), ",\"conf\":%.4f,\"track_id\":%d,\"box\":[%d,%d,%d,%d]}",
+                          detection.confidence, detection.track_id, detection.bbox.x, detection.bbox.y,
+                          detection.bbox.width, detection.bbox.height);
+            line += number;
+        }
+    }
+    line += "],\"events\":[";
+    if (result.events) {
+        bool first = true;
+        for (const ZoneEvent& event : *result.events) {
+            if (!first) line += ',';
+            first = false;
+            line += "{\"type\":\"";
+            line += zoneEventName(event.type);
+            line += "\",\"zone\":";
+            appendJsonString(line, event.zone_id);
+            std::snprintf(number, sizeof(number), ",\"track_id\":%d,\"class\":", event.track_id);
+            line += number;
+            appendJsonString(line, event.class_name);
+            std::snprintf(number, sizeof(number), ",\"dwell_ms\":%.0f}", event.dwell_ms);
+            line += number;
+        }
+    }
+    line += "]}\n";
+    out.write(line.data(), line.size());
+    return true;
+}
+
+// BinarySink class implementation
+BinarySink::BinarySink(const std::string& destination) {
+    out.open(destination);
+    record.reserve(4096);
+}
+
+bool BinarySink::write(const FrameResult& result) {
+    const size_t count = result.detections ? result.detections->size() : 0;
+    const size_t id_length = std::min<size_t>(result.stream_id.size(), 255);
+
+    record.clear();
+    appendRaw<uint32_t>(record, 0x54454459u); // "YDET" in little-endian byte order
+    appendRaw<uint32_t>(record, 0);           // payload size, patched below
+    appendRaw<uint64_t>(record, result.frame_index);
+    appendRaw<int64_t>(record, result.timestamp_ms);
+    appendRaw<uint16_t>(record, static_cast<uint16_t>(result.frame_size.width));
+    appendRaw<uint16_t>(record, static_cast<uint16_t>(result.frame_size.height));
+    appendRaw<uint8_t>(record, result.intrusion ? 1 : 0);
+    appendRaw<uint8_t>(record, static_cast<uint8_t>(id_length));
+    record.insert(record.end(), result.stream_id.begin(), result.stream_id.begin() + id_length);
+    appendRaw<uint32_t>(record, static_cast<uint32_t>(count));
+    if (result.detections) {
+        for (const Detection& detection : *result.detections) {
+            appendRaw<int32_t>(record, detection.class_id);
+            appendRaw<float>(record, detection.confidence);
+            appendRaw<int32_t>(record, detection.bbox.x);
+            appendRaw<int32_t>(record, detection.bbox.y);
+            appendRaw<int32_t>(record, detection.bbox.width);
+            appendRaw<int32_t>(record, detection.bbox.height);
+            appendRaw<int32_t>(record, detection.track_id);
+        }
+    }
+    appendRaw<uint32_t>(record, static_cast<uint32_t>(result.events ? result.events->size() : 0));
+    if (result.events) {
+        for (const ZoneEvent& event : *result.events) {
+            const size_t zone_length = std::min<size_t>(event.zone_id.size(), 255);
+            appendRaw<uint8_t>(record, static_cast<uint8_t>(event.type));
+            appendRaw<uint8_t>(record, static_cast<uint8_t>(zone_length));
+            record.insert(record.end(), event.zone_id.begin(), event.zone_id.begin() + zone_length);
+            appendRaw<int32_t>(record, event.track_id);
+            appendRaw<float>(record, static_cast<float>(event.dwell_ms));
+        }
+    }
+    uint32_t payload = static_cast<uint32_t>(record.size() - 8);
+    std::memcpy(record.data() + 4, &payload, sizeof(payload));
+    out.write(record.data(), record.size());
+    return true;
+}
+
+// VideoWriterSink class implementation
+VideoWriterSink::VideoWriterSink(const std::string& video_path, double frames_per_second)
+    : path(video_path), fps(frames_per_second > 0 ? frames_per_second : 25.0) {}
+
+bool VideoWriterSink::write(const FrameResult& result) {
+    if (result.frame.empty()) {
+        return true;
+    }
+    // Opened lazily because the frame size is only known once frames arrive
+    if (!writer.isOpened()) {
+        if (!writer.open(path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), fps, result.frame.size())) {
+            YOLO_LOG(LogLevel::Error, "Could not open video writer: " << path);
+            return true;
+        }
+    }
+    writer.write(result.frame);
+    return true;
+}
+
+// DisplaySink class implementation
+DisplaySink::DisplaySink(const std::string& window_name) : window(window_name) {}
+
+DisplaySink::~DisplaySink() {
+    cv::destroyAllWindows();
+}
+
+bool DisplaySink::write(const FrameResult& result) {
+    if (!result.frame.empty()) {
+        cv::imshow(window, result.frame);
+    }
+    return cv::waitKey(1) != 27; // ESC to exit
+}
+
+// SinkSet class implementation
+void SinkSet::add(std::unique_ptr<DetectionSink> sink) {
+    sinks.push_back(std::move(sink));
+}
+
+bool SinkSet::needsFrame() const {
+    for (const auto& sink : sinks) {
+        if (sink->needsFrame()) return true;
+    }
+    return false;
+}
+
+bool SinkSet::write(const FrameResult& result) {
+    bool keep_running = true;
+    for (const auto& sink : sinks) {
+        keep_running = sink->write(result) && keep_running;
+    }
+    return keep_running;
+}
+
+void SinkSet::flush() {
+    for (const auto& sink : sinks) {
+        sink->flush();
+    }
+}
+
+void createSinks(const OutputConfig& config, const std::string& window_name, double fps,
+                 SinkSet& sinks) {
+    for (const std::string& spec : config.records) {
+        size_t colon = spec.find(':');
+        std::string format = spec.substr(0, colon);
+        std::string destination = (colon == std::string::npos) ? "stdout" : spec.substr(colon + 1);
+        if (format == "jsonl") {
+            sinks.add(std::unique_ptr<DetectionSink>(new JsonLinesSink(destination)));
+        } else if (format == "bin") {
+            sinks.add(std::unique_ptr<DetectionSink>(new BinarySink(destination)));
+        } else {
+            YOLO_LOG(LogLevel::Error, "Unknown output format '" << format << "', expected jsonl or bin");
+        }
+    }
+    if (!config.video_path.empty()) {
+        sinks.add(std::unique_ptr<DetectionSink>(new VideoWriterSink(config.video_path, fps)));
+    }
+    if (config.display) {
+        sinks.add(std::unique_ptr<DetectionSink>(new DisplaySink(window_name)));
+    }
+}
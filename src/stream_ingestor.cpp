@@ -0,0 +1,249 @@
+#include "stream_ingestor.h"
+#include "logger.h"
+#include <algorithm>
+#include <functional>
+#include <random>
+
+// IngestConfig struct implementation
+IngestConfig::IngestConfig()
+    : reconnect_initial_ms(500), reconnect_max_ms(30000), max_reconnects(0),
+      stall_timeout_ms(5000), latest_only(true) {}
+
+// IngestStats struct implementation
+IngestStats::IngestStats()
+    : state(IngestState::Connecting), frames_grabbed(0), frames_delivered(0), frames_overwritten(0),
+      reconnects(0), last_frame_age_ms(-1), delivery_age_ms(0), healthy(false) {}
+
+const char* ingestStateName(IngestState state) {
+    switch (state) {
+        case IngestState::Connecting: return "connecting";
+        case IngestState::Streaming: return "streaming";
+        case IngestState::Reconnecting: return "reconnecting";
+        case IngestState::Ended: return "ended";
+        default: return "failed";
+    }
+}
+
+// StreamIngestor class implementation
+StreamIngestor::StreamIngestor(const std::string& source_url, const CaptureConfig& capture,
+                               const IngestConfig& cfg, const std::string& stream_id)
+    : source(source_url), id(stream_id), config(cfg), cap(capture),
+      is_live(isNetworkUrl(source_url) || isCameraIndex(source_url) ||
+              source_url.find(" ! ") != std::string::npos),
+      running(false), state(IngestState::Connecting), newest_seq(0), delivered_seq(0),
+      source_fps(0), frames_grabbed(0), frames_delivered(0), frames_overwritten(0), reconnects(0),
+      delivery_age_ms(0),
+      frames_metric(MetricsRegistry::instance().counter(
+          "yolo_ingest_frames_total", "Frames decoded per stream", {{"stream", stream_id}})),
+      overwritten_metric(MetricsRegistry::instance().counter(
+          "yolo_ingest_overwritten_total", "Live frames replaced by a newer one before being read",
+          {{"stream", stream_id}})),
+      reconnects_metric(MetricsRegistry::instance().counter(
+          "yolo_ingest_reconnects_total", "Reopen attempts per stream", {{"stream", stream_id}})),
+      healthy_metric(MetricsRegistry::instance().gauge(
+          "yolo_ingest_streaming", "1 while the stream delivers frames", {{"stream", stream_id}})),
+      age_metric(MetricsRegistry::instance().histogram(
+          "yolo_ingest_frame_age_ms", "Decode to consumer age of delivered frames in milliseconds",
+          {{"stream", stream_id}})) {
+    if (config.reconnect_initial_ms < 1) config.reconnect_initial_ms = 1;
+    config.reconnect_max_ms = std::max(config.reconnect_max_ms, config.reconnect_initial_ms);
+}
+
+StreamIngestor::~StreamIngestor() {
+    stop();
+}
+
+void StreamIngestor::setState(IngestState next) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        state = next;
+    }
+    healthy_metric.set(next == IngestState::Streaming ? 1 : 0);
+    frame_ready.notify_all();
+}
+
+bool StreamIngestor::openSource() {
+    if (!cap.open(source)) {
+        return false;
+    }
+    source_fps = cap.get(cv::CAP_PROP_FPS);
+    setState(IngestState::Streaming);
+    YOLO_LOG(LogLevel::Info, "[" << id << "] connected");
+    return true;
+}
+
+bool StreamIngestor::start() {
+    if (!is_live) {
+        if (!cap.open(source)) {
+            setState(IngestState::Failed);
+            return false;
+        }
+        source_fps = cap.get(cv::CAP_PROP_FPS);
+        setState(IngestState::Streaming);
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = true;
+    }
+    if (!openSource()) {
+        YOLO_LOG(LogLevel::Warning, "[" << id << "] could not open " << source << ", retrying in the background");
+        setState(IngestState::Reconnecting);
+    }
+    grabber = std::thread(&StreamIngestor::grabLoop, this);
+    return true;
+}
+
+void StreamIngestor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    frame_ready.notify_all();
+    if (grabber.joinable()) {
+        grabber.join();
+    }
+}
+
+bool StreamIngestor::backoff(int delay_ms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    frame_ready.wait_for(lock, std::chrono::milliseconds(delay_ms), [this] { return !running; });
+    return running;
+}
+
+void StreamIngestor::grabLoop() {
+    // Jitter keeps many cameras behind one failed switch from reconnecting in lockstep
+    std::minstd_rand random(static_cast<unsigned>(std::hash<std::string>()(source) ^
+                                                  Clock::now().time_since_epoch().count()));
+    std::uniform_real_distribution<double> jitter(0.8, 1.2);
+    int delay_ms = config.reconnect_initial_ms;
+    int failures = 0;            // attempts in a row that produced no frame
+    bool read_since_open = false;
+    cv::Mat frame;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) break;
+        }
+        if (!cap.isOpened()) {
+            // start() made the first attempt; every later one waits out the backoff
+            if (!backoff(static_cast<int>(delay_ms * jitter(random)))) break;
+            delay_ms = std::min(delay_ms * 2, config.reconnect_max_ms);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++reconnects;
+            }
+            reconnects_metric.inc();
+            read_since_open = false;
+            if (!openSource()) {
+                if (config.max_reconnects > 0 && ++failures >= config.max_reconnects) {
+                    YOLO_LOG(LogLevel::Error, "[" << id << "] giving up after " << failures << " attempts");
+                    setState(IngestState::Failed);
+                    break;
+                }
+                continue;
+            }
+        }
+
+        // Returns false on a network error and, with a read timeout, on a silent stall
+        if (!cap.read(frame) || frame.empty()) {
+            cap.release();
+            // A source that opens but never delivers a frame is a failed attempt too
+            if (!read_since_open && config.max_reconnects > 0 && ++failures >= config.max_reconnects) {
+                YOLO_LOG(LogLevel::Error, "[" << id << "] giving up after " << failures << " attempts");
+                setState(IngestState::Failed);
+                break;
+            }
+            YOLO_LOG(LogLevel::Warning, "[" << id << "] stream lost, reconnecting");
+            setState(IngestState::Reconnecting);
+            continue;
+        }
+        // Only a delivered frame proves the source healthy again
+        read_since_open = true;
+        delay_ms = config.reconnect_initial_ms;
+        failures = 0;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!config.latest_only) {
+            // Every frame is wanted: wait for the consumer instead of replacing
+            frame_ready.wait(lock, [this] { return !running || delivered_seq == newest_seq; });
+        }
+        if (newest_seq > delivered_seq) {
+            ++frames_overwritten;
+            overwritten_metric.inc();
+        }
+        newest = frame;
+        newest_time = Clock::now();
+        ++newest_seq;
+        ++frames_grabbed;
+        lock.unlock();
+        frames_metric.inc();
+        frame_ready.notify_all();
+    }
+    cap.release();
+}
+
+bool StreamIngestor::read(cv::Mat& frame, int timeout_ms) {
+    if (!is_live) {
+        // Files are read in order on the caller's thread and never reconnect
+        if (finished()) return false;
+        if (!cap.read(frame) || frame.empty()) {
+            setState(IngestState::Ended);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        newest_time = Clock::now();
+        ++frames_grabbed;
+        ++frames_delivered;
+        frames_metric.inc();
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto ready = [this] {
+        return newest_seq > delivered_seq || !running ||
+               state == IngestState::Ended || state == IngestState::Failed;
+    };
+    if (timeout_ms < 0) {
+        frame_ready.wait(lock, ready);
+    } else if (!frame_ready.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready)) {
+        return false;
+    }
+    if (newest_seq <= delivered_seq) {
+        return false;
+    }
+    frame = newest;
+    newest.release();  // the consumer holds the only reference to the ring buffer
+    delivered_seq = newest_seq;
+    ++frames_delivered;
+    const double age_ms = std::chrono::duration<double, std::milli>(Clock::now() - newest_time).count();
+    delivery_age_ms = frames_delivered == 1 ? age_ms : 0.9 * delivery_age_ms + 0.1 * age_ms;
+    lock.unlock();
+    age_metric.observe(age_ms);
+    if (!config.latest_only) {
+        frame_ready.notify_all();
+    }
+    return true;
+}
+
+bool StreamIngestor::finished() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return state == IngestState::Ended || state == IngestState::Failed;
+}
+
+IngestStats StreamIngestor::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    IngestStats stats;
+    stats.state = state;
+    stats.frames_grabbed = frames_grabbed;
+    stats.frames_delivered = frames_delivered;
+    stats.frames_overwritten = frames_overwritten;
+    stats.reconnects = reconnects;
+    stats.delivery_age_ms = delivery_age_ms;
+    if (frames_grabbed > 0) {
+        stats.last_frame_age_ms = std::chrono::duration<double, std::milli>(Clock::now() - newest_time).count();
+    }
+    stats.healthy = state == IngestState::Streaming && stats.last_frame_age_ms >= 0 &&
+                    stats.last_frame_age_ms < config.stall_timeout_ms;
+    return stats;
+}
@@ -0,0 +1,327 @@
+#include "stream_server.h"
+#include "sinks.h"
+#include "tracker.h"
+#include "zones.h"
+#include "logger.h"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+// ServerConfig struct implementation
+ServerConfig::ServerConfig()
+    : num_detectors(1), stats_interval_sec(5.0), tracking(true) {
+    // A stream holds its pending frame plus the ones in flight or being delivered
+    capture.ring_size = 4;
+}
+
+StreamState::StreamState(const StreamSpec& stream_spec, const CaptureConfig& capture,
+                         const IngestConfig& ingest_config)
+    : spec(stream_spec), frames_read(0), frames_processed(0), late_results(0),
+      last_delivered(0), finished(false),
+      ingest(new StreamIngestor(stream_spec.url, capture, ingest_config, stream_spec.id)),
+      input_sizes(stream_spec.input_size),
+      frames_read_total(MetricsRegistry::instance().counter(
+          "yolo_stream_frames_read_total", "Frames read per stream", {{"stream", stream_spec.id}})),
+      frames_processed_total(MetricsRegistry::instance().counter(
+          "yolo_stream_frames_processed_total", "Frames with results per stream", {{"stream", stream_spec.id}})),
+      late_results_total(MetricsRegistry::instance().counter(
+          "yolo_stream_late_results_total", "Results discarded behind a newer frame",
+          {{"stream", stream_spec.id}})) {}
+
+bool loadStreamManifest(const std::string& filename, ServerConfig& config) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Could not open stream manifest: " << filename << std::endl;
+        return false;
+    }
+    nlohmann::json manifest;
+    // Typed reads throw on a mistyped field just like the parse on bad syntax
+    try {
+        file >> manifest;
+
+        config.num_detectors = manifest.value("detectors", config.num_detectors);
+        config.batch.max_batch = manifest.value("max_batch", config.batch.max_batch);
+        config.batch.max_wait_ms = manifest.value("max_wait_ms", config.batch.max_wait_ms);
+        config.ingest.reconnect_initial_ms = manifest.value("reconnect_delay_ms", config.ingest.reconnect_initial_ms);
+        config.ingest.reconnect_max_ms = manifest.value("reconnect_max_ms", config.ingest.reconnect_max_ms);
+        config.ingest.max_reconnects = manifest.value("max_reconnects", config.ingest.max_reconnects);
+        config.capture.open_timeout_ms = manifest.value("open_timeout_ms", config.capture.open_timeout_ms);
+        config.capture.read_timeout_ms = manifest.value("read_timeout_ms", config.capture.read_timeout_ms);
+        config.stats_interval_sec = manifest.value("stats_interval_sec", config.stats_interval_sec);
+        config.tracking = manifest.value("tracking", config.tracking);
+        config.capture.backend = parseCaptureBackend(manifest.value("capture_backend", std::string("auto")));
+        config.capture.hw_decode = manifest.value("hw_decode", config.capture.hw_decode);
+        config.capture.decode_threads = manifest.value("decode_threads", config.capture.decode_threads);
+
+        if (manifest.contains("streams")) {
+            for (const auto& item : manifest["streams"]) {
+                if (!item.contains("url")) {
+                    std::cerr << "Stream entry without url in manifest: " << item.dump() << std::endl;
+                    continue;
+                }
+                StreamSpec spec;
+                spec.url = item["url"].get<std::string>();
+                spec.id = item.value("id", "stream" + std::to_string(config.streams.size()));
+                spec.zones_path = item.value("zones", "");
+                spec.input_size.large_size = cv::Size();
+                if (item.contains("input_size")) {
+                    const nlohmann::json& size = item["input_size"];
+                    std::string text = size.is_number() ? std::to_string(size.get<int>()) : size.get<std::string>();
+                    if (text == "auto") {
+                        spec.input_size.auto_select = true;
+                    } else if (!parseInputSize(text, spec.input_size.large_size)) {
+                        std::cerr << "Invalid input_size for stream " << spec.id << ": " << text << std::endl;
+                    }
+                }
+                config.streams.push_back(spec);
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "Invalid stream manifest " << filename << ": " << e.what() << std::endl;
+        return false;
+    }
+    if (config.streams.empty()) {
+        std::cerr << "No streams listed in manifest: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+StreamServer::StreamServer(YOLODetector& detector, const ServerConfig& cfg)
+    : config(cfg), running(false) {
+    // Every detector keeps its own scratch buffers, so each inference thread gets one
+    detectors.push_back(&detector);
+    for (int i = 1; i < config.num_detectors; ++i) {
+        owned_detectors.push_back(detector.clone());
+        detectors.push_back(owned_detectors.back().get());
+    }
+    // Only the newest frame of each stream is worth inferring
+    config.batch.per_source_capacity = 1;
+    for (StreamSpec& spec : config.streams) {
+        if (spec.input_size.large_size.area() <= 0) {
+            spec.input_size.large_size = detector.getConfig().input_size;
+        }
+        // Build every size a stream can use now rather than mid-stream on a worker
+        for (YOLODetector* worker : detectors) {
+            worker->prepareInputSize(spec.input_size.large_size);
+            if (spec.input_size.auto_select) {
+                worker->prepareInputSize(spec.input_size.small_size);
+            }
+        }
+        streams.emplace_back(new StreamState(spec, config.capture, config.ingest));
+    }
+}
+
+StreamServer::~StreamServer() {
+    stop();
+    for (auto& reader : readers) {
+        if (reader.joinable()) {
+            reader.join();
+        }
+    }
+    if (dispatcher) {
+        dispatcher->stop();
+    }
+}
+
+void StreamServer::run(const ResultHandler& handler) {
+    on_result = handler;
+    running = true;
+    dispatcher.reset(new BatchDispatcher(detectors, config.batch));
+    for (size_t i = 0; i < streams.size(); ++i) {
+        readers.emplace_back(&StreamServer::readerLoop, this, static_cast<int>(i));
+    }
+
+    auto last_report = std::chrono::steady_clock::now();
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        bool all_finished = true;
+        for (const auto& stream : streams) {
+            all_finished = all_finished && stream->finished;
+        }
+        if (all_finished) {
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (config.stats_interval_sec > 0 &&
+            std::chrono::duration<double>(now - last_report).count() >= config.stats_interval_sec) {
+            printStats();
+            last_report = now;
+        }
+    }
+
+    running = false;
+    for (auto& reader : readers) {
+        if (reader.joinable()) {
+            reader.join();
+        }
+    }
+    readers.clear();
+    // Finish what is still pending so every delivered frame gets its results
+    dispatcher->stop();
+    printStats();
+}
+
+void StreamServer::stop() {
+    running = false;
+}
+
+void StreamServer::readerLoop(int source_id) {
+    StreamState& stream = *streams[source_id];
+    StreamIngestor& source = *stream.ingest;
+    if (!source.start()) {
+        std::cerr << "[" << stream.spec.id << "] could not open " << stream.spec.url << std::endl;
+        stream.finished = true;
+        return;
+    }
+    uint64_t frame_index = 0;
+    // Video files are played back at their own frame rate, like a live camera
+    std::chrono::steady_clock::duration frame_interval(0);
+    if (!source.live() && source.fps() > 0) {
+        frame_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / source.fps()));
+    }
+    auto next_frame_time = std::chrono::steady_clock::now();
+
+    while (running) {
+        if (frame_interval.count() > 0) {
+            std::this_thread::sleep_until(next_frame_time);
+            next_frame_time = std::max(next_frame_time + frame_interval,
+                                       std::chrono::steady_clock::now());
+        }
+
+        cv::Mat frame;
+        // Live streams reconnect inside the ingestor; the timeout only lets the loop see stop()
+        if (!source.read(frame, 200)) {
+            if (source.finished()) break; // end of file, or the stream gave up
+            continue;
+        }
+        ++stream.frames_read;
+        stream.frames_read_total.inc();
+
+        uint64_t index = frame_index++;
+        StreamState* state = &stream;
+        cv::Mat submitted = frame;
+        cv::Size input_size = stream.input_sizes.current();
+        dispatcher->submit(source_id, frame, [this, state, index, submitted, input_size](std::vector<Detection>&& detections) {
+            // Two workers may finish consecutive frames of a stream out of order
+            uint64_t delivered = state->last_delivered;
+            while (index + 1 > delivered) {
+                if (state->last_delivered.compare_exchange_weak(delivered, index + 1)) break;
+            }
+            if (index + 1 <= delivered) {
+                ++state->late_results;
+                state->late_results_total.inc();
+                return;
+            }
+            ++state->frames_processed;
+            state->frames_processed_total.inc();
+            if (state->input_sizes.enabled()) {
+                std::lock_guard<std::mutex> lock(state->input_size_mutex);
+                state->input_sizes.update(detections, submitted.size(), input_size, 0);
+            }
+            if (on_result) {
+                std::vector<Detection> results(std::move(detections));
+                on_result(*state, index, submitted, results);
+            }
+        }, input_size);
+    }
+    source.stop();
+    stream.finished = true;
+}
+
+void StreamServer::printStats() const {
+    BatchDispatcherStats batch_stats = dispatcher ? dispatcher->getStats() : BatchDispatcherStats();
+    YOLO_LOG(LogLevel::Info, "[server] batches=" << batch_stats.batches
+              << " frames=" << batch_stats.frames_processed
+              << " dropped=" << batch_stats.frames_dropped
+              << " pending=" << batch_stats.pending);
+    for (const auto& stream : streams) {
+        const IngestStats ingest = stream->ingest->getStats();
+        YOLO_LOG(LogLevel::Info, "  [" << stream->spec.id << "] "
+                  << (stream->finished ? "finished" : ingestStateName(ingest.state))
+                  << (ingest.state == IngestState::Streaming && !ingest.healthy ? " (stalled)" : "")
+                  << " read=" << stream->frames_read
+                  << " processed=" << stream->frames_processed
+                  << " late=" << stream->late_results
+                  << " reconnects=" << ingest.reconnects
+                  << " age_ms=" << ingest.delivery_age_ms
+                  << " input=" << stream->input_sizes.current().width << "x"
+                  << stream->input_sizes.current().height);
+    }
+}
+
+void run_stream_server(const std::string& manifest_path, YOLODetector& detector,
+                       const OutputConfig& output_config) {
+    ServerConfig config;
+    if (!loadStreamManifest(manifest_path, config)) {
+        return;
+    }
+    YOLO_LOG(LogLevel::Info, "Serving " << config.streams.size() << " streams with "
+              << config.num_detectors << " detectors");
+
+    // Results arrive on the inference threads, so only thread-agnostic record sinks are used
+    OutputConfig server_output = output_config;
+    if (server_output.display || !server_output.video_path.empty()) {
+        YOLO_LOG(LogLevel::Warning, "Display and video output are not available in server mode");
+        server_output.display = false;
+        server_output.video_path.clear();
+    }
+    SinkSet sinks;
+    createSinks(server_output, "", 0, sinks);
+    std::mutex sinks_mutex;
+    // One tracker per stream with the index of the last frame it saw
+    std::map<std::string, std::pair<MultiObjectTracker, uint64_t>> trackers;
+    std::map<std::string, ZoneEngine> zones;
+    for (const StreamSpec& spec : config.streams) {
+        if (spec.zones_path.empty()) continue;
+        if (zones[spec.id].load(spec.zones_path, detector.getConfig().class_names)) {
+            YOLO_LOG(LogLevel::Info, "Stream " << spec.id << ": " << zones[spec.id].zones().size() << " zones");
+        } else {
+            YOLO_LOG(LogLevel::Warning, "Stream " << spec.id << ": could not load zones from "
+                     << spec.zones_path << ", waiting for the file to change");
+        }
+    }
+    std::vector<ZoneEvent> events;
+
+    StreamServer server(detector, config);
+    server.run([&](const StreamState& stream, uint64_t frame_index, const cv::Mat& frame,
+                   std::vector<Detection>& detections) {
+        if (sinks.empty()) return;
+        std::lock_guard<std::mutex> lock(sinks_mutex);
+        if (config.tracking) {
+            auto inserted = trackers.emplace(stream.spec.id, std::make_pair(MultiObjectTracker(), frame_index));
+            auto& tracked = inserted.first->second;
+            // Results of a stream arrive in order; frames dropped on the way still count
+            if (inserted.second || frame_index > tracked.second) {
+                int elapsed = inserted.second ? 1 : static_cast<int>(frame_index - tracked.second);
+                tracked.first.update(detections, elapsed);
+                tracked.second = frame_index;
+            }
+        }
+        FrameResult result;
+        result.stream_id = stream.spec.id;
+        result.frame_index = frame_index;
+        result.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        result.frame_size = frame.size();
+        result.detections = &detections;
+        auto zone_engine = zones.find(stream.spec.id);
+        // Every stream with a zone file is watched, so one that starts empty can gain zones
+        if (zone_engine != zones.end()) {
+            zone_engine->second.reloadIfChanged(result.timestamp_ms);
+        }
+        if (zone_engine != zones.end() && !zone_engine->second.empty()) {
+            events.clear();
+            result.intrusion = zone_engine->second.update(detections, detector.getConfidenceThreshold(),
+                                                          result.timestamp_ms, events);
+            result.events = &events;
+        }
+        sinks.write(result);
+    });
+    sinks.flush();
+}
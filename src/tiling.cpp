@@ -0,0 +1,179 @@
+#include "tiling.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <thread>
+
+// TilingConfig struct implementation
+TilingConfig::TilingConfig()
+    : enabled(false), zones_only(false), tile_size(0, 0), overlap(0.2f), max_batch(4),
+      workers(1), full_frame(true), merge_iou(0.4f) {}
+
+namespace {
+
+// Tile origins along one axis covering [start, start + length)
+std::vector<int> tilePositions(int start, int length, int tile, int frame_length, float overlap) {
+    std::vector<int> positions;
+    if (length <= tile) {
+        // Grow a small area to a whole tile around its centre instead of upscaling it
+        int position = start + (length - tile) / 2;
+        positions.push_back(std::min(std::max(position, 0), frame_length - tile));
+        return positions;
+    }
+    int stride = std::max(1, static_cast<int>(tile * (1.f - overlap)));
+    int count = (length - tile + stride - 1) / stride + 1;
+    for (int i = 0; i < count; ++i) {
+        positions.push_back(start + static_cast<int>(std::lround(
+            static_cast<double>(i) * (length - tile) / (count - 1))));
+    }
+    return positions;
+}
+
+} // namespace
+
+std::vector<cv::Rect> makeTiles(const cv::Rect& area, const cv::Size& tile_size, float overlap,
+                                const cv::Size& frame_size) {
+    std::vector<cv::Rect> tiles;
+    cv::Rect bounds = area & cv::Rect(0, 0, frame_size.width, frame_size.height);
+    if (bounds.empty()) {
+        return tiles;
+    }
+    int tile_w = std::min(tile_size.width, frame_size.width);
+    int tile_h = std::min(tile_size.height, frame_size.height);
+    overlap = std::min(std::max(overlap, 0.f), 0.9f);
+    std::vector<int> xs = tilePositions(bounds.x, bounds.width, tile_w, frame_size.width, overlap);
+    std::vector<int> ys = tilePositions(bounds.y, bounds.height, tile_h, frame_size.height, overlap);
+    for (int y : ys) {
+        for (int x : xs) {
+            tiles.emplace_back(x, y, tile_w, tile_h);
+        }
+    }
+    return tiles;
+}
+
+// TiledDetector class implementation
+TiledDetector::TiledDetector(YOLODetector& base_detector, const TilingConfig& cfg)
+    : detector(base_detector), config(cfg), regions(cfg.regions) {
+    const YOLOConfig& detector_config = detector.getConfig();
+    if (config.tile_size.area() <= 0) {
+        config.tile_size = detector_config.input_size;
+    }
+    config.max_batch = std::max(1, config.max_batch);
+    // YOLODetector is not thread-safe, so every parallel worker needs its own
+    detectors.push_back(&detector);
+    for (int i = 1; i < config.workers; ++i) {
+        owned_detectors.push_back(detector.clone());
+        detectors.push_back(owned_detectors.back().get());
+    }
+    merger.configure(NmsMethod::Hard, detector_config.nms_per_class, 0, 0.5f);
+}
+
+void TiledDetector::setRegions(const std::vector<cv::Rect>& rois) {
+    regions = rois;
+    layout_size = cv::Size();
+}
+
+void TiledDetector::buildLayout(const cv::Size& frame_size) {
+    tiles.clear();
+    std::vector<cv::Rect> areas = regions;
+    if (areas.empty()) {
+        areas.push_back(cv::Rect(0, 0, frame_size.width, frame_size.height));
+    }
+    for (const cv::Rect& area : areas) {
+        for (const cv::Rect& tile : makeTiles(area, config.tile_size, config.overlap, frame_size)) {
+            // Neighbouring regions often produce the same tile
+            if (std::find(tiles.begin(), tiles.end(), tile) == tiles.end()) {
+                tiles.push_back(tile);
+            }
+        }
+    }
+    layout_size = frame_size;
+}
+
+std::vector<Detection> TiledDetector::detect(const cv::Mat& frame) {
+    if (frame.size() != layout_size) {
+        buildLayout(frame.size());
+    }
+    // A frame that fits in a single tile gains nothing from slicing
+    if (regions.empty() && tiles.size() <= 1) {
+        return detector.detect(frame);
+    }
+
+    std::vector<cv::Mat> images;
+    std::vector<cv::Point> offsets;
+    images.reserve(tiles.size() + 1);
+    for (const cv::Rect& tile : tiles) {
+        images.push_back(frame(tile));
+        offsets.push_back(tile.tl());
+    }
+    if (config.full_frame) {
+        images.push_back(frame);
+        offsets.push_back(cv::Point(0, 0));
+    }
+
+    // Fixed-size batches, spread round-robin over the detectors
+    const int count = static_cast<int>(images.size());
+    const int chunks = (count + config.max_batch - 1) / config.max_batch;
+    const int workers = std::min(static_cast<int>(detectors.size()), chunks);
+    std::vector<std::vector<Detection>> results(count);
+    auto runWorker = [&](int worker) {
+        for (int chunk = worker; chunk < chunks; chunk += workers) {
+            int begin = chunk * config.max_batch;
+            int end = std::min(begin + config.max_batch, count);
+            std::vector<cv::Mat> batch(images.begin() + begin, images.begin() + end);
+            std::vector<std::vector<Detection>> batch_results = detectors[worker]->detectBatch(batch);
+            for (int i = begin; i < end; ++i) {
+                results[i] = std::move(batch_results[i - begin]);
+            }
+        }
+    };
+    // Plain threads, not cv::parallel_for_: OpenCV runs nested parallel regions serially,
+    // which would leave each worker's forward pass and preprocessing single-threaded
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(workers);
+    for (int worker = 1; worker < workers; ++worker) {
+        threads.emplace_back([&, worker] {
+            try {
+                runWorker(worker);
+            } catch (...) {
+                errors[worker] = std::current_exception();
+            }
+        });
+    }
+    try {
+        runWorker(0);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Back to frame coordinates, then one NMS across all tiles for the seams
+    std::vector<Detection> candidates;
+    for (int i = 0; i < count; ++i) {
+        for (Detection& detection : results[i]) {
+            detection.bbox += offsets[i];
+            candidates.push_back(std::move(detection));
+        }
+    }
+    boxes.clear();
+    confidences.clear();
+    class_ids.clear();
+    for (const Detection& detection : candidates) {
+        boxes.push_back(detection.bbox);
+        confidences.push_back(detection.confidence);
+        class_ids.push_back(detection.class_id);
+    }
+    merger.run(boxes, confidences, class_ids, 0.f, config.merge_iou, indices);
+
+    std::vector<Detection> detections;
+    detections.reserve(indices.size());
+    for (int idx : indices) {
+        detections.push_back(std::move(candidates[idx]));
+    }
+    return detections;
+}
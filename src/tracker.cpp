@@ -0,0 +1,247 @@
+#include "tracker.h"
+#include <algorithm>
+#include <limits>
+
+// TrackerConfig struct implementation
+TrackerConfig::TrackerConfig()
+    : match_iou(0.3f), high_confidence(0.5f), min_hits(2), max_age(15), class_aware(true) {}
+
+namespace {
+
+float rectIoU(const cv::Rect& a, const cv::Rect& b) {
+    int inter = (a & b).area();
+    int uni = a.area() + b.area() - inter;
+    return uni > 0 ? static_cast<float>(inter) / uni : 0.f;
+}
+
+// Minimum-cost assignment of every row to a distinct column (rows <= cols), Hungarian
+// algorithm with potentials in O(rows^2 * cols)
+void solveAssignment(const std::vector<double>& cost, int rows, int cols,
+                     std::vector<int>& row_to_col) {
+    const double inf = std::numeric_limits<double>::max();
+    std::vector<double> u(rows + 1, 0), v(cols + 1, 0), min_slack(cols + 1);
+    std::vector<int> col_owner(cols + 1, 0), way(cols + 1, 0);
+    std::vector<char> used(cols + 1);
+    for (int i = 1; i <= rows; ++i) {
+        col_owner[0] = i;
+        int j0 = 0;
+        std::fill(min_slack.begin(), min_slack.end(), inf);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[j0] = 1;
+            int i0 = col_owner[j0];
+            int j1 = 0;
+            double delta = inf;
+            for (int j = 1; j <= cols; ++j) {
+                if (used[j]) continue;
+                double slack = cost[(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+                if (slack < min_slack[j]) {
+                    min_slack[j] = slack;
+                    way[j] = j0;
+                }
+                if (min_slack[j] < delta) {
+                    delta = min_slack[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= cols; ++j) {
+                if (used[j]) {
+                    u[col_owner[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    min_slack[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (col_owner[j0] != 0);
+        do {
+            int j1 = way[j0];
+            col_owner[j0] = col_owner[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    row_to_col.assign(rows, -1);
+    for (int j = 1; j <= cols; ++j) {
+        if (col_owner[j] != 0) {
+            row_to_col[col_owner[j] - 1] = j - 1;
+        }
+    }
+}
+
+// Constant velocity model over (cx, cy, w, h); noise scales with the box height
+void initFilter(cv::KalmanFilter& filter, const cv::Rect& box) {
+    filter.init(8, 4, 0, CV_32F);
+    cv::setIdentity(filter.transitionMatrix);
+    for (int i = 0; i < 4; ++i) {
+        filter.transitionMatrix.at<float>(i, i + 4) = 1.f;
+    }
+    filter.measurementMatrix = cv::Mat::zeros(4, 8, CV_32F);
+    for (int i = 0; i < 4; ++i) {
+        filter.measurementMatrix.at<float>(i, i) = 1.f;
+    }
+    const float position_std = 0.05f * std::max(box.height, 1);
+    const float velocity_std = 0.00625f * std::max(box.height, 1);
+    filter.processNoiseCov = cv::Mat::zeros(8, 8, CV_32F);
+    filter.errorCovPost = cv::Mat::zeros(8, 8, CV_32F);
+    for (int i = 0; i < 4; ++i) {
+        filter.processNoiseCov.at<float>(i, i) = position_std * position_std;
+        filter.processNoiseCov.at<float>(i + 4, i + 4) = velocity_std * velocity_std;
+        filter.errorCovPost.at<float>(i, i) = 4 * position_std * position_std;
+        filter.errorCovPost.at<float>(i + 4, i + 4) = 100 * velocity_std * velocity_std;
+    }
+    cv::setIdentity(filter.measurementNoiseCov, cv::Scalar(position_std * position_std));
+    filter.statePost = cv::Mat::zeros(8, 1, CV_32F);
+    filter.statePost.at<float>(0) = box.x + 0.5f * box.width;
+    filter.statePost.at<float>(1) = box.y + 0.5f * box.height;
+    filter.statePost.at<float>(2) = static_cast<float>(box.width);
+    filter.statePost.at<float>(3) = static_cast<float>(box.height);
+}
+
+cv::Rect stateToRect(const cv::Mat& state) {
+    float cx = state.at<float>(0);
+    float cy = state.at<float>(1);
+    float w = std::max(state.at<float>(2), 1.f);
+    float h = std::max(state.at<float>(3), 1.f);
+    return cv::Rect(cvRound(cx - 0.5f * w), cvRound(cy - 0.5f * h), cvRound(w), cvRound(h));
+}
+
+} // namespace
+
+// MultiObjectTracker class implementation
+MultiObjectTracker::MultiObjectTracker(const TrackerConfig& cfg)
+    : config(cfg), next_id(1), measurement(4, 1, CV_32F) {}
+
+void MultiObjectTracker::advance(int frames) {
+    for (Track& track : tracks) {
+        for (int i = 0; i < std::max(frames, 1); ++i) {
+            track.filter.predict();
+        }
+        track.predicted = stateToRect(track.filter.statePre);
+    }
+}
+
+void MultiObjectTracker::update(std::vector<Detection>& detections, int elapsed_frames) {
+    advance(elapsed_frames);
+
+    confident.clear();
+    weak.clear();
+    for (int i = 0; i < static_cast<int>(detections.size()); ++i) {
+        detections[i].track_id = -1;
+        (detections[i].confidence >= config.high_confidence ? confident : weak).push_back(i);
+    }
+    open_tracks.resize(tracks.size());
+    for (int t = 0; t < static_cast<int>(tracks.size()); ++t) {
+        open_tracks[t] = t;
+    }
+
+    // Confident detections first; low-score ones can only extend existing tracks
+    associate(detections, confident, open_tracks, unmatched);
+    associate(detections, weak, open_tracks, discarded);
+
+    for (int t : open_tracks) {
+        ++tracks[t].misses;
+    }
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+                                [this](const Track& track) { return track.misses > config.max_age; }),
+                 tracks.end());
+    for (int d : unmatched) {
+        startTrack(detections[d]);
+    }
+}
+
+std::vector<Detection> MultiObjectTracker::predict(int elapsed_frames) {
+    advance(elapsed_frames);
+    std::vector<Detection> predicted;
+    for (const Track& track : tracks) {
+        if (track.id > 0 && track.misses == 0) {
+            predicted.emplace_back(track.class_id, track.confidence, track.predicted, track.class_name);
+            predicted.back().track_id = track.id;
+        }
+    }
+    return predicted;
+}
+
+void MultiObjectTracker::associate(std::vector<Detection>& detections,
+                                   const std::vector<int>& detection_indices,
+                                   std::vector<int>& open, std::vector<int>& unmatched_detections) {
+    unmatched_detections.clear();
+    const int num_tracks = static_cast<int>(open.size());
+    const int num_detections = static_cast<int>(detection_indices.size());
+    if (num_tracks == 0 || num_detections == 0) {
+        unmatched_detections = detection_indices;
+        return;
+    }
+
+    // The solver wants rows <= cols, so the smaller side becomes the rows
+    const bool tracks_are_rows = num_tracks <= num_detections;
+    const int rows = tracks_are_rows ? num_tracks : num_detections;
+    const int cols = tracks_are_rows ? num_detections : num_tracks;
+    cost.assign(static_cast<size_t>(rows) * cols, 1.0);
+    for (int t = 0; t < num_tracks; ++t) {
+        const Track& track = tracks[open[t]];
+        for (int d = 0; d < num_detections; ++d) {
+            const Detection& detection = detections[detection_indices[d]];
+            if (config.class_aware && detection.class_id != track.class_id) continue;
+            float iou = rectIoU(track.predicted, detection.bbox);
+            size_t cell = tracks_are_rows ? static_cast<size_t>(t) * cols + d
+                                          : static_cast<size_t>(d) * cols + t;
+            cost[cell] = 1.0 - iou;
+        }
+    }
+    solveAssignment(cost, rows, cols, assignment);
+
+    std::vector<char> track_matched(num_tracks, 0);
+    std::vector<char> detection_matched(num_detections, 0);
+    for (int r = 0; r < rows; ++r) {
+        int c = assignment[r];
+        if (c < 0) continue;
+        int t = tracks_are_rows ? r : c;
+        int d = tracks_are_rows ? c : r;
+        // The solver assigns every row; pairs below the IoU gate are no match
+        if (1.0 - cost[static_cast<size_t>(r) * cols + c] < config.match_iou) continue;
+        correct(tracks[open[t]], detections[detection_indices[d]]);
+        track_matched[t] = 1;
+        detection_matched[d] = 1;
+    }
+
+    int kept = 0;
+    for (int t = 0; t < num_tracks; ++t) {
+        if (!track_matched[t]) open[kept++] = open[t];
+    }
+    open.resize(kept);
+    for (int d = 0; d < num_detections; ++d) {
+        if (!detection_matched[d]) unmatched_detections.push_back(detection_indices[d]);
+    }
+}
+
+void MultiObjectTracker::correct(Track& track, Detection& detection) {
+    const cv::Rect& box = detection.bbox;
+    measurement.at<float>(0) = box.x + 0.5f * box.width;
+    measurement.at<float>(1) = box.y + 0.5f * box.height;
+    measurement.at<float>(2) = static_cast<float>(box.width);
+    measurement.at<float>(3) = static_cast<float>(box.height);
+    track.filter.correct(measurement);
+    track.confidence = detection.confidence;
+    track.misses = 0;
+    if (++track.hits >= config.min_hits && track.id == 0) {
+        track.id = next_id++;
+    }
+    detection.track_id = track.id > 0 ? track.id : -1;
+}
+
+void MultiObjectTracker::startTrack(Detection& detection) {
+    Track track;
+    track.id = 0;
+    track.class_id = detection.class_id;
+    track.class_name = detection.class_name;
+    track.confidence = detection.confidence;
+    track.predicted = detection.bbox;
+    track.hits = 1;
+    track.misses = 0;
+    initFilter(track.filter, detection.bbox);
+    if (config.min_hits <= 1) {
+        track.id = next_id++;
+        detection.track_id = track.id;
+    }
+    tracks.push_back(std::move(track));
+}
@@ -0,0 +1,205 @@
+#include "yolo_decode.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+
+namespace {
+
+// Best class score and its index; an all-zero row yields (0, 0) like the scalar loop
+inline float scalarArgmax(const float* scores, int count, int& best_index) {
+    float max_score = 0;
+    best_index = 0;
+    for (int j = 0; j < count; ++j) {
+        if (scores[j] > max_score) {
+            max_score = scores[j];
+            best_index = j;
+        }
+    }
+    return max_score;
+}
+
+inline float simdArgmax(const float* scores, int count, int& best_index) {
+#if CV_SIMD
+    const int lanes = CV_SIMD_WIDTH / static_cast<int>(sizeof(float));
+    if (count >= lanes) {
+        cv::v_float32 vmax = cv::vx_load(scores);
+        int j = lanes;
+        for (; j <= count - lanes; j += lanes) {
+            vmax = cv::v_max(vmax, cv::vx_load(scores + j));
+        }
+        float max_score = cv::v_reduce_max(vmax);
+        for (; j < count; ++j) {
+            max_score = std::max(max_score, scores[j]);
+        }
+        best_index = 0;
+        if (max_score <= 0) {
+            return 0;
+        }
+        // First occurrence of the maximum, matching the scalar tie-breaking
+        best_index = static_cast<int>(std::find(scores, scores + count, max_score) - scores);
+        return max_score;
+    }
+#endif
+    return scalarArgmax(scores, count, best_index);
+}
+
+// Normalized network coordinates -> image pixels, folded into one multiply-add per axis
+struct BoxMapping {
+    float kx, bx, ky, by;
+    cv::Size image_size;
+
+    explicit BoxMapping(const LetterboxTransform& t)
+        : kx(t.input_size.width / t.scale_x), bx(-t.pad_x / t.scale_x),
+          ky(t.input_size.height / t.scale_y), by(-t.pad_y / t.scale_y),
+          image_size(t.image_size) {}
+};
+
+inline void appendBox(const float* data, float confidence, int class_id, const BoxMapping& mapping,
+                      std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                      std::vector<int>& class_ids) {
+    const cv::Size image_size = mapping.image_size;
+
+    // Convert normalized coordinates to pixel coordinates
+    // cx, cy, w, h are in range [0, 1] relative to input size; undo the
+    // letterbox padding and scaling to get back to the original image
+    float pixel_cx = data[0] * mapping.kx + mapping.bx;
+    float pixel_cy = data[1] * mapping.ky + mapping.by;
+    float pixel_w = data[2] * mapping.kx;
+    float pixel_h = data[3] * mapping.ky;
+
+    // Convert center coordinates to top-left corner
+    int left = static_cast<int>(pixel_cx - 0.5 * pixel_w);
+    int top = static_cast<int>(pixel_cy - 0.5 * pixel_h);
+    int width = static_cast<int>(pixel_w);
+    int height = static_cast<int>(pixel_h);
+
+    // Ensure bounding box is within image bounds
+    left = std::max(0, left);
+    top = std::max(0, top);
+    width = std::min(width, image_size.width - left);
+    height = std::min(height, image_size.height - top);
+
+    if (width > 0 && height > 0) {
+        boxes.emplace_back(left, top, width, height);
+        confidences.push_back(confidence);
+        class_ids.push_back(class_id);
+    }
+}
+
+// Full evaluation of a row that already passed the objectness test
+inline void decodeCandidate(const float* data, int cols, float conf_threshold, const BoxMapping& mapping,
+                            std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                            std::vector<int>& class_ids) {
+    int best_class_id = 0;
+    float max_class_score = simdArgmax(data + 5, cols - 5, best_class_id);
+    if (max_class_score > conf_threshold) {
+        appendBox(data, data[4], best_class_id, mapping, boxes, confidences, class_ids);
+    }
+}
+
+} // namespace
+
+void decodeYoloRows(const float* data, int rows, int cols, float conf_threshold,
+                    const LetterboxTransform& transform, std::vector<cv::Rect>& boxes,
+                    std::vector<float>& confidences, std::vector<int>& class_ids) {
+    const BoxMapping mapping(transform);
+    int i = 0;
+#if CV_SIMD
+    // Gather the objectness column of `lanes` consecutive rows into one register
+    // and reject the whole block with a single compare when nothing passes
+    const int lanes = CV_SIMD_WIDTH / static_cast<int>(sizeof(float));
+    int objectness_offsets[CV_SIMD_WIDTH / sizeof(float)];
+    for (int k = 0; k < lanes; ++k) {
+        objectness_offsets[k] = k * cols + 4;
+    }
+    const cv::v_float32 threshold = cv::vx_setall_f32(conf_threshold);
+    for (; i <= rows - lanes; i += lanes) {
+        const float* block = data + static_cast<size_t>(i) * cols;
+        cv::v_float32 objectness = cv::v_lut(block, objectness_offsets);
+        int mask = cv::v_signmask(objectness >= threshold);
+        if (mask == 0) {
+            continue;
+        }
+        for (int k = 0; k < lanes; ++k) {
+            if (mask & (1 << k)) {
+                decodeCandidate(block + k * cols, cols, conf_threshold, mapping,
+                                boxes, confidences, class_ids);
+            }
+        }
+    }
+    cv::vx_cleanup();
+#endif
+    for (; i < rows; ++i) {
+        const float* row = data + static_cast<size_t>(i) * cols;
+        if (row[4] >= conf_threshold) {
+            decodeCandidate(row, cols, conf_threshold, mapping, boxes, confidences, class_ids);
+        }
+    }
+}
+
+void decodeYoloRowsScalar(const float* data, int rows, int cols, float conf_threshold,
+                          const LetterboxTransform& transform, std::vector<cv::Rect>& boxes,
+                          std::vector<float>& confidences, std::vector<int>& class_ids) {
+    const BoxMapping mapping(transform);
+    for (int i = 0; i < rows; ++i) {
+        const float* row = data + static_cast<size_t>(i) * cols;
+        if (row[4] >= conf_threshold) {
+            int best_class_id = 0;
+            float max_class_score = scalarArgmax(row + 5, cols - 5, best_class_id);
+            if (max_class_score > conf_threshold) {
+                appendBox(row, row[4], best_class_id, mapping, boxes, confidences, class_ids);
+            }
+        }
+    }
+}
+
+void decodeAnchorFreeColumns(const float* data, int channels, int anchors, float conf_threshold,
+                             const LetterboxTransform& transform, std::vector<cv::Rect>& boxes,
+                             std::vector<float>& confidences, std::vector<int>& class_ids,
+                             std::vector<float>& best_scores, std::vector<float>& best_classes) {
+    const BoxMapping mapping(transform);
+    const int num_classes = channels - 4;
+    best_scores.assign(anchors, 0.f);
+    best_classes.assign(anchors, 0.f);
+    float* best = best_scores.data();
+    float* best_id = best_classes.data();
+
+    // Running max over the class rows; strict > keeps the first class on ties
+    for (int c = 0; c < num_classes; ++c) {
+        const float* scores = data + static_cast<size_t>(4 + c) * anchors;
+        int a = 0;
+#if CV_SIMD
+        const int lanes = CV_SIMD_WIDTH / static_cast<int>(sizeof(float));
+        const cv::v_float32 class_id = cv::vx_setall_f32(static_cast<float>(c));
+        for (; a <= anchors - lanes; a += lanes) {
+            cv::v_float32 score = cv::vx_load(scores + a);
+            cv::v_float32 current = cv::vx_load(best + a);
+            cv::v_float32 better = score > current;
+            cv::v_store(best + a, cv::v_select(better, score, current));
+            cv::v_store(best_id + a, cv::v_select(better, class_id, cv::vx_load(best_id + a)));
+        }
+#endif
+        for (; a < anchors; ++a) {
+            if (scores[a] > best[a]) {
+                best[a] = scores[a];
+                best_id[a] = static_cast<float>(c);
+            }
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+
+    for (int a = 0; a < anchors; ++a) {
+        if (best[a] > conf_threshold) {
+            const float box[4] = {data[a], data[anchors + a], data[2 * anchors + a], data[3 * anchors + a]};
+            appendBox(box, best[a], static_cast<int>(best_id[a]), mapping, boxes, confidences, class_ids);
+        }
+    }
+}
+
+LetterboxTransform inputPixelTransform(const LetterboxTransform& transform) {
+    // BoxMapping scales by input_size / scale; a unit input size leaves 1 / scale
+    LetterboxTransform pixels = transform;
+    pixels.input_size = cv::Size(1, 1);
+    return pixels;
+}
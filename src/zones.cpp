@@ -0,0 +1,443 @@
+#include "zones.h"
+#include "logger.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace {
+
+// Grid cell edge in pixels: small enough that a cell holds a handful of zones
+// even with hundreds of them per camera
+const int kCellSize = 64;
+
+bool isAxisAlignedRect(const std::vector<cv::Point2f>& polygon) {
+    if (polygon.size() != 4) return false;
+    for (size_t i = 0; i < 4; ++i) {
+        const cv::Point2f& a = polygon[i];
+        const cv::Point2f& b = polygon[(i + 1) % 4];
+        if (a.x != b.x && a.y != b.y) return false;
+    }
+    return true;
+}
+
+cv::Rect polygonBounds(const std::vector<cv::Point2f>& polygon) {
+    float min_x = polygon[0].x, max_x = polygon[0].x;
+    float min_y = polygon[0].y, max_y = polygon[0].y;
+    for (const cv::Point2f& p : polygon) {
+        min_x = std::min(min_x, p.x);
+        max_x = std::max(max_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_y = std::max(max_y, p.y);
+    }
+    int x0 = static_cast<int>(std::floor(min_x));
+    int y0 = static_cast<int>(std::floor(min_y));
+    return cv::Rect(x0, y0, static_cast<int>(std::ceil(max_x)) - x0, static_cast<int>(std::ceil(max_y)) - y0);
+}
+
+bool segmentsCross(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy) {
+    auto side = [](float px, float py, float qx, float qy, float rx, float ry) {
+        return (qx - px) * (ry - py) - (qy - py) * (rx - px);
+    };
+    float d1 = side(cx, cy, dx, dy, ax, ay);
+    float d2 = side(cx, cy, dx, dy, bx, by);
+    float d3 = side(ax, ay, bx, by, cx, cy);
+    float d4 = side(ax, ay, bx, by, dx, dy);
+    return ((d1 > 0) != (d2 > 0)) && ((d3 > 0) != (d4 > 0));
+}
+
+int64_t fileStamp(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return -1;
+    }
+    return static_cast<int64_t>(info.st_mtime) * 1000003 + static_cast<int64_t>(info.st_size);
+}
+
+} // namespace
+
+// Zone struct implementation
+Zone::Zone() : anchor(ZoneAnchor::BottomCenter), min_dwell_ms(0) {}
+
+bool Zone::acceptsClass(int class_id) const {
+    return class_ids.empty() || std::find(class_ids.begin(), class_ids.end(), class_id) != class_ids.end();
+}
+
+const char* zoneEventName(ZoneEventType type) {
+    switch (type) {
+        case ZoneEventType::Enter: return "enter";
+        case ZoneEventType::Exit: return "exit";
+        default: return "dwell";
+    }
+}
+
+bool loadZones(const std::string& path, const std::vector<std::string>& class_names,
+               std::vector<Zone>& zones) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        YOLO_LOG(LogLevel::Error, "Could not open zone file: " << path);
+        return false;
+    }
+    nlohmann::json doc;
+    try {
+        file >> doc;
+    } catch (const nlohmann::json::exception& e) {
+        YOLO_LOG(LogLevel::Error, "Invalid zone file " << path << ": " << e.what());
+        return false;
+    }
+
+    // Built aside so the caller's zones stay untouched when the file is rejected
+    std::vector<Zone> loaded;
+    try {
+        if (doc.is_array()) {
+            // Legacy boxes.json: rectangles that fire on any overlap
+            for (const auto& item : doc) {
+                auto number = [&item](const char* key) { return item.contains(key) && item[key].is_number(); };
+                if (!item.is_object() || !(number("x1") && number("y1") && number("x2") && number("y2"))) {
+                    YOLO_LOG(LogLevel::Warning, "Invalid box in zone file: " << item.dump());
+                    continue;
+                }
+                Zone zone;
+                zone.id = "box" + std::to_string(loaded.size());
+                float x1 = item["x1"].get<float>(), y1 = item["y1"].get<float>();
+                float x2 = item["x2"].get<float>(), y2 = item["y2"].get<float>();
+                zone.polygon = {cv::Point2f(x1, y1), cv::Point2f(x2, y1), cv::Point2f(x2, y2), cv::Point2f(x1, y2)};
+                zone.anchor = ZoneAnchor::Overlap;
+                loaded.push_back(zone);
+            }
+            zones.swap(loaded);
+            return true;
+        }
+
+        if (!doc.is_object() || !doc.contains("zones") || !doc["zones"].is_array()) {
+            YOLO_LOG(LogLevel::Error, "Zone file has no \"zones\" list: " << path);
+            return false;
+        }
+        for (const auto& item : doc["zones"]) {
+            if (!item.is_object()) {
+                YOLO_LOG(LogLevel::Warning, "Invalid zone in zone file: " << item.dump());
+                continue;
+            }
+            Zone zone;
+            zone.id = item.contains("id") && item["id"].is_string() ? item["id"].get<std::string>()
+                                                                    : "zone" + std::to_string(loaded.size());
+            if (item.contains("polygon") && item["polygon"].is_array()) {
+                for (const auto& point : item["polygon"]) {
+                    if (point.is_array() && point.size() >= 2 && point[0].is_number() && point[1].is_number()) {
+                        zone.polygon.emplace_back(point[0].get<float>(), point[1].get<float>());
+                    }
+                }
+            }
+            if (zone.polygon.size() < 3) {
+                YOLO_LOG(LogLevel::Warning, "Zone " << zone.id << " needs at least 3 points, skipped");
+                continue;
+            }
+            if (item.contains("classes") && item["classes"].is_array()) {
+                for (const auto& cls : item["classes"]) {
+                    if (cls.is_number_integer()) {
+                        zone.class_ids.push_back(cls.get<int>());
+                        continue;
+                    }
+                    if (!cls.is_string()) {
+                        YOLO_LOG(LogLevel::Warning, "Zone " << zone.id << ": invalid class " << cls.dump());
+                        continue;
+                    }
+                    std::string name = cls.get<std::string>();
+                    auto it = std::find(class_names.begin(), class_names.end(), name);
+                    if (it == class_names.end()) {
+                        YOLO_LOG(LogLevel::Warning, "Zone " << zone.id << ": unknown class " << name);
+                        continue;
+                    }
+                    zone.class_ids.push_back(static_cast<int>(it - class_names.begin()));
+                }
+            }
+            std::string anchor = item.contains("anchor") && item["anchor"].is_string()
+                ? item["anchor"].get<std::string>() : "bottom";
+            zone.anchor = anchor == "center" ? ZoneAnchor::Center
+                        : anchor == "overlap" ? ZoneAnchor::Overlap
+                        : ZoneAnchor::BottomCenter;
+            if (item.contains("min_dwell_ms") && item["min_dwell_ms"].is_number()) {
+                zone.min_dwell_ms = item["min_dwell_ms"].get<double>();
+            }
+            loaded.push_back(zone);
+        }
+    } catch (const nlohmann::json::exception& e) {
+        // A mistyped file saved while running must not take the process down
+        YOLO_LOG(LogLevel::Error, "Invalid zone file " << path << ": " << e.what());
+        return false;
+    }
+    zones.swap(loaded);
+    return true;
+}
+
+// ZoneEngine class implementation
+ZoneEngine::ZoneEngine()
+    : has_overlap_zones(false), cell_size(kCellSize), grid_cols(0), grid_rows(0), visit_stamp(0), source_stamp(-1),
+      last_reload_check_ms(0), exit_grace_ms(1000) {}
+
+bool ZoneEngine::load(const std::string& path, const std::vector<std::string>& names) {
+    // Remembered even if loading fails, so a missing or broken file is picked up once fixed
+    source_path = path;
+    class_names = names;
+    source_stamp = fileStamp(path);
+    std::vector<Zone> zones;
+    if (!loadZones(path, names, zones)) {
+        return false;
+    }
+    setZones(zones);
+    return true;
+}
+
+void ZoneEngine::setZones(const std::vector<Zone>& zones) {
+    // Objects already inside a zone that survives the change keep their presence
+    std::map<std::string, int> new_index;
+    for (size_t i = 0; i < zones.size(); ++i) {
+        new_index[zones[i].id] = static_cast<int>(i);
+    }
+    std::map<std::pair<int, int>, Presence> kept;
+    for (const auto& entry : presences) {
+        auto it = new_index.find(zone_list[entry.first.first].id);
+        if (it != new_index.end()) {
+            kept[std::make_pair(it->second, entry.first.second)] = entry.second;
+        }
+    }
+    presences.swap(kept);
+
+    zone_list = zones;
+    zone_edges.assign(zone_list.size(), std::vector<Edge>());
+    zone_is_rect.assign(zone_list.size(), false);
+    has_overlap_zones = false;
+    occupied.assign(zone_list.size(), false);
+    for (size_t z = 0; z < zone_list.size(); ++z) {
+        Zone& zone = zone_list[z];
+        zone.bounds = polygonBounds(zone.polygon);
+        zone_is_rect[z] = isAxisAlignedRect(zone.polygon);
+        has_overlap_zones = has_overlap_zones || zone.anchor == ZoneAnchor::Overlap;
+        for (size_t i = 0; i < zone.polygon.size(); ++i) {
+            const cv::Point2f& a = zone.polygon[i];
+            const cv::Point2f& b = zone.polygon[(i + 1) % zone.polygon.size()];
+            zone_edges[z].push_back(Edge{a.x, a.y, b.x, b.y});
+        }
+    }
+    buildIndex();
+}
+
+void ZoneEngine::buildIndex() {
+    grid_area = cv::Rect();
+    for (const Zone& zone : zone_list) {
+        grid_area = grid_area.area() > 0 ? (grid_area | zone.bounds) : zone.bounds;
+    }
+    grid_cols = std::max(1, (grid_area.width + cell_size - 1) / cell_size);
+    grid_rows = std::max(1, (grid_area.height + cell_size - 1) / cell_size);
+
+    // Counting pass, then fill: every zone is listed in each cell its bounds touch
+    cell_start.assign(static_cast<size_t>(grid_cols) * grid_rows + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<int> fill;
+        if (pass == 1) {
+            for (size_t c = 1; c < cell_start.size(); ++c) cell_start[c] += cell_start[c - 1];
+            cell_zones.assign(cell_start.back(), 0);
+            fill.assign(cell_start.begin(), cell_start.end() - 1);
+        }
+        for (int z = 0; z < static_cast<int>(zone_list.size()); ++z) {
+            const cv::Rect& b = zone_list[z].bounds;
+            int c0 = (b.x - grid_area.x) / cell_size;
+            int r0 = (b.y - grid_area.y) / cell_size;
+            int c1 = std::min(grid_cols - 1, (b.x + b.width - grid_area.x) / cell_size);
+            int r1 = std::min(grid_rows - 1, (b.y + b.height - grid_area.y) / cell_size);
+            for (int r = r0; r <= r1; ++r) {
+                for (int c = c0; c <= c1; ++c) {
+                    size_t cell = static_cast<size_t>(r) * grid_cols + c;
+                    if (pass == 0) {
+                        ++cell_start[cell + 1];
+                    } else {
+                        cell_zones[fill[cell]++] = z;
+                    }
+                }
+            }
+        }
+    }
+    visited.assign(zone_list.size(), 0);
+    visit_stamp = 0;
+}
+
+bool ZoneEngine::reloadIfChanged(int64_t now_ms) {
+    if (source_path.empty() || now_ms - last_reload_check_ms < 1000) {
+        return false;
+    }
+    last_reload_check_ms = now_ms;
+    int64_t stamp = fileStamp(source_path);
+    if (stamp < 0 || stamp == source_stamp) {
+        return false;
+    }
+    // A broken file is retried when it changes again, not every second
+    source_stamp = stamp;
+    std::vector<Zone> zones;
+    if (!loadZones(source_path, class_names, zones)) {
+        return false; // keep the current zones while the file is being edited
+    }
+    setZones(zones);
+    YOLO_LOG(LogLevel::Info, "Reloaded " << zone_list.size() << " zones from " << source_path);
+    return true;
+}
+
+bool ZoneEngine::contains(int zone_index, const cv::Rect& box) const {
+    const Zone& zone = zone_list[zone_index];
+    const std::vector<Edge>& edges = zone_edges[zone_index];
+    auto inside = [&](float px, float py) {
+        if (zone_is_rect[zone_index]) {
+            return px >= zone.bounds.x && px < zone.bounds.x + zone.bounds.width &&
+                   py >= zone.bounds.y && py < zone.bounds.y + zone.bounds.height;
+        }
+        // Even-odd ray casting
+        bool in = false;
+        for (const Edge& e : edges) {
+            if ((e.y0 > py) != (e.y1 > py) &&
+                px < e.x0 + (py - e.y0) * (e.x1 - e.x0) / (e.y1 - e.y0)) {
+                in = !in;
+            }
+        }
+        return in;
+    };
+
+    switch (zone.anchor) {
+        case ZoneAnchor::BottomCenter:
+            return inside(box.x + 0.5f * box.width, static_cast<float>(box.y + box.height));
+        case ZoneAnchor::Center:
+            return inside(box.x + 0.5f * box.width, box.y + 0.5f * box.height);
+        default:
+            break;
+    }
+
+    if ((box & zone.bounds).area() <= 0) {
+        return false;
+    }
+    if (zone_is_rect[zone_index]) {
+        return true;
+    }
+    // Overlap with a general polygon: a box corner inside the polygon, a polygon
+    // vertex inside the box, or crossing edges
+    const float x0 = static_cast<float>(box.x), y0 = static_cast<float>(box.y);
+    const float x1 = x0 + box.width, y1 = y0 + box.height;
+    if (inside(x0, y0) || inside(x1, y0) || inside(x1, y1) || inside(x0, y1)) {
+        return true;
+    }
+    for (const Edge& e : edges) {
+        if (e.x0 >= x0 && e.x0 <= x1 && e.y0 >= y0 && e.y0 <= y1) {
+            return true;
+        }
+        if (segmentsCross(e.x0, e.y0, e.x1, e.y1, x0, y0, x1, y0) ||
+            segmentsCross(e.x0, e.y0, e.x1, e.y1, x1, y0, x1, y1) ||
+            segmentsCross(e.x0, e.y0, e.x1, e.y1, x1, y1, x0, y1) ||
+            segmentsCross(e.x0, e.y0, e.x1, e.y1, x0, y1, x0, y0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ZoneEngine::pushEvent(ZoneEventType type, int zone, int track_id, const Presence& presence,
+                           int64_t now_ms, std::vector<ZoneEvent>& events) const {
+    ZoneEvent event;
+    event.type = type;
+    event.zone_id = zone_list[zone].id;
+    event.track_id = track_id;
+    event.class_id = presence.class_id;
+    event.class_name = presence.class_name;
+    event.dwell_ms = static_cast<double>(now_ms - presence.entered_ms);
+    events.push_back(event);
+}
+
+void ZoneEngine::matchDetection(const Detection& detection, int64_t now_ms,
+                                std::vector<ZoneEvent>& events) {
+    // Cells to look at: every cell under the box if overlap zones exist, otherwise
+    // only the cells on the vertical centre line between the two anchor points
+    const cv::Rect& box = detection.bbox;
+    cv::Rect query = box;
+    if (!has_overlap_zones) {
+        int cy = box.y + box.height / 2;
+        query = cv::Rect(box.x + box.width / 2, cy, 1, box.y + box.height - cy + 1);
+    }
+    cv::Rect cells = query & grid_area;
+    if (cells.area() <= 0) {
+        return;
+    }
+    int c0 = (cells.x - grid_area.x) / cell_size;
+    int r0 = (cells.y - grid_area.y) / cell_size;
+    int c1 = std::min(grid_cols - 1, (cells.x + cells.width - grid_area.x) / cell_size);
+    int r1 = std::min(grid_rows - 1, (cells.y + cells.height - grid_area.y) / cell_size);
+
+    if (++visit_stamp == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        visit_stamp = 1;
+    }
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            size_t cell = static_cast<size_t>(r) * grid_cols + c;
+            for (int k = cell_start[cell]; k < cell_start[cell + 1]; ++k) {
+                int z = cell_zones[k];
+                if (visited[z] == visit_stamp) continue;
+                visited[z] = visit_stamp;
+                if (!zone_list[z].acceptsClass(detection.class_id) || !contains(z, box)) continue;
+
+                occupied[z] = true;
+                if (detection.track_id < 0) continue;
+                auto key = std::make_pair(z, detection.track_id);
+                auto it = presences.find(key);
+                if (it == presences.end()) {
+                    Presence presence;
+                    presence.entered_ms = now_ms;
+                    presence.last_seen_ms = now_ms;
+                    presence.class_id = detection.class_id;
+                    presence.class_name = detection.class_name;
+                    presence.dwell_reported = false;
+                    it = presences.emplace(key, presence).first;
+                    pushEvent(ZoneEventType::Enter, z, detection.track_id, presence, now_ms, events);
+                }
+                Presence& presence = it->second;
+                presence.last_seen_ms = now_ms;
+                if (zone_list[z].min_dwell_ms > 0 && !presence.dwell_reported &&
+                    now_ms - presence.entered_ms >= zone_list[z].min_dwell_ms) {
+                    presence.dwell_reported = true;
+                    pushEvent(ZoneEventType::Dwell, z, detection.track_id, presence, now_ms, events);
+                }
+            }
+        }
+    }
+}
+
+bool ZoneEngine::update(const std::vector<Detection>& detections, float min_confidence, int64_t now_ms,
+                        std::vector<ZoneEvent>& events) {
+    std::fill(occupied.begin(), occupied.end(), false);
+    if (zone_list.empty()) {
+        return false;
+    }
+    for (const Detection& detection : detections) {
+        if (detection.confidence >= min_confidence) {
+            matchDetection(detection, now_ms, events);
+        }
+    }
+    // Objects not seen in a zone for a while have left it
+    for (auto it = presences.begin(); it != presences.end();) {
+        if (now_ms - it->second.last_seen_ms > exit_grace_ms) {
+            pushEvent(ZoneEventType::Exit, it->first.first, it->first.second, it->second,
+                      it->second.last_seen_ms, events);
+            it = presences.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return std::find(occupied.begin(), occupied.end(), true) != occupied.end();
+}
+
+void ZoneEngine::draw(cv::Mat& frame) const {
+    for (size_t z = 0; z < zone_list.size(); ++z) {
+        std::vector<std::vector<cv::Point>> outline(1);
+        for (const cv::Point2f& p : zone_list[z].polygon) {
+            outline[0].push_back(cv::Point(cvRound(p.x), cvRound(p.y)));
+        }
+        cv::Scalar color = occupied[z] ? cv::Scalar(0, 0, 255) : cv::Scalar(255, 0, 0);
+        cv::polylines(frame, outline, true, color, 2);
+    }
+}